@@ -0,0 +1,173 @@
+//count the heap allocations of the tessellation per vertex, a reused tessellator should make none in the steady state
+//
+//usage: AllocationBenchmark [font file] [options]
+//    --first <index>         the first glyph index, 3000 by default
+//    --glyphs <n>            number of glyphs, 500 by default
+//    --passes <n>            passes over the glyphs with one tessellator, 2 by default
+//
+//the glyphs of the font(../fonts/STXINWEI.TTF by default) are tessellated by one Tessellator again and again,
+//every operator new of the program is counted, for every pass the allocations of
+//    GLU callbacks   the contours fed to GLU between beginTessellation and endTessellation,
+//                    the vertices and the intersections GLU creates come from the scratch pools
+//    tessellate()    the ear clipping with the GLU fallback, including the output arrays written to the glyph
+//are reported, the first pass fills the pools and the later ones must not allocate in the GLU callbacks
+//
+//the mallocs inside GLU are C allocations and are not counted
+#include <FontRegistry.h>
+#include <FreeTypeFont.h>
+#include <Tessellator.h>
+#include <Triangulator.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+static size_t numAllocations = 0;
+
+void* operator new(size_t size)
+{
+	++numAllocations;
+	void *p = std::malloc(size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	std::free(p);
+}
+
+struct BenchmarkOptions
+{
+	std::string fontFile = "../fonts/STXINWEI.TTF";
+	FT_UInt first = 3000;
+	unsigned int glyphs = 500;
+	unsigned int passes = 2;
+};
+
+static void printUsage()
+{
+	std::cout << "usage: AllocationBenchmark [font file] [--first 3000] [--glyphs 500] [--passes 2]" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, BenchmarkOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg.compare(0, 2, "--") != 0)
+		{
+			options.fontFile = arg;
+			continue;
+		}
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing the value of " << arg << std::endl;
+			return false;
+		}
+		std::string value = argv[++i];
+
+		if (arg == "--first")
+			options.first = std::strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--glyphs")
+			options.glyphs = std::strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--passes")
+			options.passes = std::strtoul(value.c_str(), nullptr, 10);
+		else
+		{
+			std::cerr << "Unknown option " << arg << std::endl;
+			return false;
+		}
+	}
+	return options.glyphs > 0 && options.passes > 1;
+}
+
+int main(int argc, char **argv)
+{
+	BenchmarkOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return 1;
+	}
+
+	FontRegistry fonts;
+	FontFace *font = fonts.getFace(options.fontFile);
+	if (!font)
+	{
+		std::cerr << "Failed to load font " << options.fontFile << std::endl;
+		return 1;
+	}
+
+	//the contours of the glyphs, every pass tessellates copies of them
+	std::vector<Glyph3D> glyphs;
+	size_t numVertices = 0;
+	for (FT_UInt index = options.first; index < options.first + options.glyphs && index < FT_UInt(font->face->num_glyphs); ++index)
+	{
+		FreeTypeFont ft(font, index);
+		if (!ft.isValid()) continue;
+		glyphs.push_back(ft.getGlyph3D());
+		numVertices += glyphs.back()._vertices.size();
+	}
+	if (numVertices == 0)
+	{
+		std::cerr << "No outline in the glyphs " << options.first << " to " << options.first + options.glyphs - 1 << std::endl;
+		return 1;
+	}
+
+	//the glyphs the ear clipping can't handle go to GLU
+	unsigned int numFallbacks = 0;
+	Triangulator triangulator;
+	for (const auto &g : glyphs)
+	{
+		Glyph3D copy = g;
+		if (!triangulator.triangulate(copy))
+			++numFallbacks;
+	}
+
+	std::cout << options.fontFile << ": " << glyphs.size() << " glyphs, " << numVertices << " vertices, "
+		<< numFallbacks << " glyphs tessellated by GLU" << std::endl;
+
+	Tessellator ts;
+	size_t steadyCallbacks = 0;
+	for (unsigned int pass = 0; pass < options.passes; ++pass)
+	{
+		std::vector<Glyph3D> contours = glyphs;
+		size_t start = numAllocations;
+		for (auto &g : contours)
+		{
+			Vec3Array &vertices = g._vertices;
+			ts.beginTessellation();
+			for (const auto &contour : g._elements)
+			{
+				ts.beginContour();
+				for (auto i : contour)
+					ts.addVertex(&vertices[i]);
+				ts.endContour();
+			}
+			ts.endTessellation();
+		}
+		size_t callbacks = numAllocations - start;
+
+		std::vector<Glyph3D> copies = glyphs;
+		start = numAllocations;
+		for (auto &g : copies)
+			ts.tessellate(g);
+		size_t tessellate = numAllocations - start;
+
+		std::cout << "  pass " << pass << ": GLU callbacks " << callbacks << " allocations(" << double(callbacks) / numVertices
+			<< " per vertex), tessellate() " << tessellate << " allocations(" << double(tessellate) / glyphs.size() << " per glyph, "
+			<< double(tessellate) / numVertices << " per vertex)" << std::endl;
+		if (pass > 0)
+			steadyCallbacks += callbacks;
+	}
+
+	return steadyCallbacks ? 2 : 0;
+}
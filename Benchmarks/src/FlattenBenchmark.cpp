@@ -0,0 +1,172 @@
+//measure the batched evaluation of the Bezier samples against the per curve loop it replaced
+//
+//usage: FlattenBenchmark [font file] [options]
+//    --repeat <n>            evaluations of every glyph's batch in a round, 20 by default
+//    --tolerance <float>     Bezier flattening tolerance in 1/64 pixel
+//
+//the curves of every character of the font(../fonts/STXINWEI.TTF by default) are recorded by decomposeOutline,
+//then every glyph's batch is evaluated by
+//    old loop      the loop of conicTo/cubicTo before the batch: one curve after another,
+//                  conics by their rational Bernstein form with the weight divide, cubics in power basis
+//    scalar        evaluateBezierBatchScalar
+//    kernel        evaluateBezierBatch, the SIMD kernel selected at compile time
+//the kernel must give the same bits as the scalar loop, the distance to the old loop is reported
+#include <FontRegistry.h>
+#include <FreeTypeFont.h>
+#include <BezierKernel.h>
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+struct BenchmarkOptions
+{
+	std::string fontFile = "../fonts/STXINWEI.TTF";
+	unsigned int repeat = 20;
+	float tolerance = FreeType::DefaultTolerance;
+};
+
+//the samples of the curves one by one, the way FreeType::Char3DInfo flattened them before the batch
+static void evaluateOldLoop(const BezierBatch &batch, glm::vec2 *samples)
+{
+	for (unsigned int s = 0; s < batch.size(); ++s)
+	{
+		glm::vec2 a(batch.ax[s], batch.ay[s]), b(batch.bx[s], batch.by[s]), c(batch.cx[s], batch.cy[s]), d(batch.dx[s], batch.dy[s]);
+		glm::vec2 *out = samples + batch.first[s];
+		float dt = 1.0f / batch.steps[s];
+		if (a == glm::vec2(0.0f))
+		{
+			//the control points of the conic
+			glm::vec2 p0 = d, p1 = d + c * 0.5f, p2 = b + p1 * 2.0f - p0;
+			for (unsigned int i = 1; i < batch.steps[s]; ++i)
+			{
+				float u = i * dt;
+				float w = 1;
+				float bs = 1.0f / ((1 - u) * (1 - u) + 2 * (1 - u) * u * w + u * u);
+				*out++ = (p0 * ((1 - u) * (1 - u)) + p1 * (2 * (1 - u) * u * w) + p2 * (u * u)) * bs;
+			}
+		}
+		else
+		{
+			for (unsigned int i = 1; i < batch.steps[s]; ++i)
+			{
+				float u = i * dt;
+				*out++ = glm::vec2(a.x * u * u * u + b.x * u * u + c.x * u + d.x, a.y * u * u * u + b.y * u * u + c.y * u + d.y);
+			}
+		}
+	}
+}
+
+//the milliseconds to evaluate every batch repeat times
+template <typename Evaluate>
+static double measure(const std::vector<BezierBatch> &batches, unsigned int repeat, std::vector<glm::vec2> &samples, Evaluate evaluate)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	for (const auto &batch : batches)
+		for (unsigned int r = 0; r < repeat; ++r)
+			evaluate(batch, samples.data());
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void printUsage()
+{
+	std::cout << "usage: FlattenBenchmark [font file] [--repeat 20] [--tolerance " << FreeType::DefaultTolerance << "]" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, BenchmarkOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg.compare(0, 2, "--") != 0)
+		{
+			options.fontFile = arg;
+			continue;
+		}
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing the value of " << arg << std::endl;
+			return false;
+		}
+		std::string value = argv[++i];
+
+		if (arg == "--repeat")
+			options.repeat = std::strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--tolerance")
+			options.tolerance = std::strtof(value.c_str(), nullptr);
+		else
+		{
+			std::cerr << "Unknown option " << arg << std::endl;
+			return false;
+		}
+	}
+	return options.repeat > 0 && options.tolerance > 0.0f;
+}
+
+int main(int argc, char **argv)
+{
+	BenchmarkOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return 1;
+	}
+
+	FontRegistry fonts;
+	FontFace *font = fonts.getFace(options.fontFile);
+	if (!font)
+	{
+		std::cerr << "Failed to load font " << options.fontFile << std::endl;
+		return 1;
+	}
+
+	//the curves of every glyph mapped by a character
+	std::vector<BezierBatch> batches;
+	size_t numCurves = 0, numSamples = 0;
+	unsigned int maxSamples = 0;
+	FT_UInt index;
+	for (FT_ULong c = FT_Get_First_Char(font->face, &index); index != 0; c = FT_Get_Next_Char(font->face, c, &index))
+	{
+		if (FT_Load_Glyph(font->face, index, FT_LOAD_DEFAULT)) continue;
+		FreeType::Char3DInfo char3d(options.tolerance);
+		if (!FreeType::decomposeOutline(font->face->glyph->outline, char3d)) continue;
+		numCurves += char3d.curves.size();
+		numSamples += char3d.curves.num_samples;
+		maxSamples = std::max(maxSamples, char3d.curves.num_samples);
+		batches.push_back(char3d.curves);
+	}
+
+	std::vector<glm::vec2> samples(maxSamples), scalar(maxSamples), kernel(maxSamples);
+	double oldTime = measure(batches, options.repeat, samples, evaluateOldLoop);
+	double scalarTime = measure(batches, options.repeat, samples, evaluateBezierBatchScalar);
+	double kernelTime = measure(batches, options.repeat, samples, evaluateBezierBatch);
+
+	//the kernel against the scalar loop bit by bit, and the batch against the old loop in pixels
+	unsigned int different = 0;
+	float maxDistance = 0.0f;
+	for (const auto &batch : batches)
+	{
+		if (batch.num_samples == 0) continue;
+		evaluateOldLoop(batch, samples.data());
+		evaluateBezierBatchScalar(batch, scalar.data());
+		evaluateBezierBatch(batch, kernel.data());
+		if (std::memcmp(scalar.data(), kernel.data(), batch.num_samples * sizeof(glm::vec2)) != 0)
+			++different;
+		for (unsigned int i = 0; i < batch.num_samples; ++i)
+			maxDistance = std::max(maxDistance, glm::length(scalar[i] - samples[i]) / 64.0f);
+	}
+
+	std::cout << options.fontFile << ": " << batches.size() << " glyphs, " << numCurves << " curves, " << numSamples
+		<< " samples, every batch evaluated " << options.repeat << " times" << std::endl;
+	std::cout << "  old loop: " << oldTime << " ms" << std::endl;
+	std::cout << "  scalar:   " << scalarTime << " ms" << std::endl;
+	std::cout << "  kernel(" << bezierKernelName() << "): " << kernelTime << " ms, " << oldTime / kernelTime << "x faster than the old loop" << std::endl;
+	std::cout << "  " << different << " batches differ between " << bezierKernelName() << " and scalar, max distance to the old loop "
+		<< maxDistance << " pixels" << std::endl;
+
+	return different ? 2 : 0;
+}
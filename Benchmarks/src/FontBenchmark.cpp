@@ -0,0 +1,156 @@
+//measure the build time of the glyph meshes per 1000 characters with and without a shared font face
+//
+//usage: FontBenchmark [font file] [options]
+//    --chars <n>             characters to build in a round, 1000 by default
+//    --rounds <n>            rounds of each mode, the fastest one is reported, 5 by default
+//    --depth <float>         extrusion depth, 3.0 by default
+//
+//the font is ../fonts/STXINWEI.TTF by default, the characters cycle over a line of chinese and latin text,
+//every character is loaded, decomposed, tessellated and extruded
+//    per character   every character opens its own FontRegistry, i.e. its own FT_Library, font file and face,
+//                    the way FreeTypeFont worked before the faces were shared
+//    shared face     one face of one FontRegistry serves every character
+#include <FontRegistry.h>
+#include <FreeTypeFont.h>
+#include <Tessellator.h>
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+struct BenchmarkOptions
+{
+	std::string fontFile = "../fonts/STXINWEI.TTF";
+	unsigned int chars = 1000;
+	unsigned int rounds = 5;
+	float depth = 3.0f;
+};
+
+//the result of a round
+struct RoundResult
+{
+	double milliseconds;
+	size_t vertices;
+	unsigned int failed;
+};
+
+//the chinese and latin characters of the demo text, some more chinese characters, letters and digits
+static const std::vector<FT_ULong> SampleText = {
+	0x5317, 0x90AE, 'I', 'P', 'O', 'C', 'O', 'S', 'G', 0x4E09, 0x7EF4, 0x6587, 0x5B57, 0x6E32, 0x67D3, 0x6D4B, 0x8BD5,
+	'a', 'b', 'c', 'X', 'Y', 'Z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9'
+};
+
+static bool buildChar(FontFace *font, FT_ULong charcode, float depth, Tessellator &ts, RoundResult &result)
+{
+	FreeTypeFont ft(font, font->glyphIndex(charcode));
+	if (!ft.isValid()) return false;
+	Glyph3D glyph = ft.getGlyph3D();
+	if (!computeGlyphGeometry(glyph, depth, ts)) return false;
+	result.vertices += glyph._vertices.size();
+	return true;
+}
+
+static RoundResult runRound(const BenchmarkOptions &options, bool shared)
+{
+	RoundResult result{ 0.0, 0, 0 };
+	Tessellator ts;
+	auto start = std::chrono::high_resolution_clock::now();
+
+	if (shared)
+	{
+		FontRegistry fonts;
+		FontFace *font = fonts.getFace(options.fontFile);
+		for (unsigned int i = 0; i < options.chars; ++i)
+			if (!font || !buildChar(font, SampleText[i % SampleText.size()], options.depth, ts, result))
+				++result.failed;
+	}
+	else
+	{
+		for (unsigned int i = 0; i < options.chars; ++i)
+		{
+			FontRegistry fonts;
+			FontFace *font = fonts.getFace(options.fontFile);
+			if (!font || !buildChar(font, SampleText[i % SampleText.size()], options.depth, ts, result))
+				++result.failed;
+		}
+	}
+
+	result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return result;
+}
+
+static RoundResult runMode(const BenchmarkOptions &options, bool shared)
+{
+	RoundResult best = runRound(options, shared);
+	for (unsigned int r = 1; r < options.rounds; ++r)
+	{
+		RoundResult result = runRound(options, shared);
+		if (result.milliseconds < best.milliseconds)
+			best = result;
+	}
+	return best;
+}
+
+static void printUsage()
+{
+	std::cout << "usage: FontBenchmark [font file] [--chars 1000] [--rounds 5] [--depth 3.0]" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, BenchmarkOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg.compare(0, 2, "--") != 0)
+		{
+			options.fontFile = arg;
+			continue;
+		}
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing the value of " << arg << std::endl;
+			return false;
+		}
+		std::string value = argv[++i];
+
+		if (arg == "--chars")
+			options.chars = std::strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--rounds")
+			options.rounds = std::strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--depth")
+			options.depth = std::strtof(value.c_str(), nullptr);
+		else
+		{
+			std::cerr << "Unknown option " << arg << std::endl;
+			return false;
+		}
+	}
+	return options.chars > 0 && options.rounds > 0 && options.depth > 0.0f;
+}
+
+int main(int argc, char **argv)
+{
+	BenchmarkOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return 1;
+	}
+
+	std::cout << options.fontFile << ", " << options.chars << " characters, best of " << options.rounds << " rounds" << std::endl;
+	RoundResult perChar = runMode(options, false);
+	RoundResult shared = runMode(options, true);
+
+	auto report = [&options](const char *name, const RoundResult &r)
+	{
+		std::cout << name << r.milliseconds * 1000.0 / options.chars << " ms per 1k characters, "
+			<< r.vertices << " vertices, " << r.failed << " failed" << std::endl;
+	};
+	report("  per character: ", perChar);
+	report("  shared face:   ", shared);
+	std::cout << "  speedup " << perChar.milliseconds / shared.milliseconds << "x" << std::endl;
+
+	return perChar.failed || shared.failed ? 2 : 0;
+}
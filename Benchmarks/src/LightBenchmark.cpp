@@ -0,0 +1,348 @@
+//render a wall of 3D text lit by hundreds of point and spot lights without showing a window,
+//once with every light in one cluster(every fragment evaluates every light) and once with the clustered lights
+//
+//usage: LightBenchmark [options]
+//    --lights <n>            point and spot lights, every 4th one is a spot light, 256 by default
+//    --frames <n>            frames of each mode, the fastest one is reported, 5 by default
+//    --quadratic <float>     quadratic attenuation of the lights, a larger one gives smaller lights, 300 by default
+//    --font <file>           ../fonts/STXINWEI.TTF by default
+//    --shaders <dir>         the directory of text3D.vert and text3D.frag, ../Render_with_OpenGL/shader/ by default
+//
+//the frames are drawn to an offscreen framebuffer of a hidden window, so the program also runs on a software driver
+//(e.g. mesa llvmpipe) of a machine without a display server that GLFW can use
+//a light is cut off at its radius in both modes, so they must give the same image, the program returns 2 if a pixel differs
+#include <glad\glad.h>
+#include <GLFW\glfw3.h>
+
+#include <glm\glm.hpp>
+#include <glm\gtc\matrix_transform.hpp>
+
+#include <Shader.h>
+#include <ShaderCache.h>
+#include <Light.h>
+#include <FrameConstants.h>
+#include <LightClusters.h>
+#include <GlyphMeshStore.h>
+#include <TextBatch.h>
+
+#include <FontRegistry.h>
+#include <FreeTypeFont.h>
+#include <GlyphMeshCache.h>
+#include <VertexQuantizer.h>
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+const GLuint WIDTH = 800;
+const GLuint HEIGHT = 600;
+
+struct BenchmarkOptions
+{
+	unsigned int lights = 256;
+	unsigned int frames = 5;
+	float quadratic = 300.0f;
+	std::string fontFile = "../fonts/STXINWEI.TTF";
+	std::string shaderDir = "../Render_with_OpenGL/shader/";
+};
+
+//the result of a mode
+struct ModeResult
+{
+	double frameTime;      //the fastest frame, milliseconds
+	double buildTime;      //the cluster build of that frame, milliseconds
+	size_t indices;        //the light indices of the clusters
+	std::vector<unsigned char> image;
+};
+
+//the lights over the wall, the same for every run
+static std::vector<LightBlock> createLights(const BenchmarkOptions &options)
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> u(0.0f, 1.0f);
+	std::vector<LightBlock> lights;
+	for (unsigned int i = 0; i < options.lights; ++i)
+	{
+		glm::vec3 color(u(rng), u(rng), u(rng));
+		glm::vec3 position(-2.9f + 5.8f * u(rng), -2.0f + 4.1f * u(rng), 0.05f + 0.3f * u(rng));
+		PointLight point
+		{
+			position,
+			color * 0.02f,
+			color * 0.8f,
+			glm::vec3(0.3f, 0.3f, 0.3f),
+			{ 1.0f, 10.0f, options.quadratic }
+		};
+		if (i % 4 != 3)
+		{
+			lights.push_back(point.block());
+			continue;
+		}
+		//a spot light a little in front of the wall, looking at it
+		SpotLight spot
+		{
+			position + glm::vec3(0.0f, 0.0f, 0.4f),
+			glm::vec3(0.0f, 0.0f, -1.0f),
+			point.ambient,
+			point.diffuse,
+			point.specular,
+			point.atten,
+			{ glm::cos(glm::radians(20.0f)), glm::cos(glm::radians(30.0f)) }
+		};
+		lights.push_back(spot.block());
+	}
+	return lights;
+}
+
+//lay a line of text out as instances of the batch, pen is in the units of the glyph advances
+static bool addText(TextBatch &batch, GlyphMeshStore &store, GlyphMeshCache &cache, FontFace *font,
+	const std::string &text, const glm::vec3 &origin, float scale)
+{
+	GLuint pen = 0, lastAdvance = 0;
+	for (char c : text)
+	{
+		if (c == ' ')
+		{
+			pen += lastAdvance;
+			continue;
+		}
+		FT_UInt index = font->glyphIndex(c);
+		std::shared_ptr<const GlyphMesh> mesh = cache.get(font, index, FreeType::DefaultTolerance, 3.0f);
+		if (!mesh) return false;
+
+		unsigned long long key = GlyphMeshStore::key(font->id, index);
+		int glyph = store.find(key);
+		if (glyph < 0)
+		{
+			std::vector<QuantizedVertex> verts;
+			QuantizationBounds bounds = quantizeGlyph(mesh->glyph, verts);
+			const std::vector<GLuint> &indices = mesh->glyph.getIndices();
+			glyph = store.add(key, verts.data(), verts.size(), indices.data(), indices.size(), bounds);
+		}
+		glm::mat4 model = glm::translate(glm::mat4(), origin + glm::vec3(pen * scale, 0.0f, 0.0f));
+		batch.addInstance(glyph, glm::scale(model, glm::vec3(scale, scale, scale)));
+		lastAdvance = mesh->advanceX;
+		pen += lastAdvance;
+	}
+	return true;
+}
+
+static ModeResult runMode(LightClusters &clusters, const std::vector<LightBlock> &lights, Shader *shaders[2], TextBatch &wall,
+	const BenchmarkOptions &options)
+{
+	const glm::vec3 eye(0.0f, 0.0f, 5.0f);
+	glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 proj = glm::perspective(glm::radians(45.0f), (GLfloat)WIDTH / HEIGHT, 0.1f, 100.0f);
+
+	DirLight dLight
+	{
+		glm::vec3(-0.2f, -1.0f, -0.3f),
+		glm::vec3(0.01f, 0.01f, 0.01f),
+		glm::vec3(0.2f, 0.2f, 0.2f),
+		glm::vec3(0.5f, 0.5f, 0.5f)
+	};
+	FrameConstants<LightsBlock> frameConstants;
+	frameConstants.matrix.view = view;
+	frameConstants.matrix.projection = proj;
+	frameConstants.lights.dirLight = dLight.block();
+	clusters.lights = lights;
+
+	UniformHandle<glm::vec3> viewPosUniforms[2] = { shaders[0]->uniform<glm::vec3>("viewPos"), shaders[1]->uniform<glm::vec3>("viewPos") };
+
+	ModeResult result{ 0.0, 0.0, 0, {} };
+	for (unsigned int f = 0; f < options.frames; ++f)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		clusters.build(view, proj, 0.1f, 100.0f, WIDTH, HEIGHT);
+		auto built = std::chrono::high_resolution_clock::now();
+		clusters.setBlock(frameConstants.lights);
+		clusters.upload();
+		frameConstants.upload();
+
+		int variant = clusters.getSpotLightsNum() > 0 ? 1 : 0;
+		shaders[variant]->use();
+		shaders[variant]->set(viewPosUniforms[variant], eye);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		wall.draw();
+		frameConstants.endFrame();
+		glFinish();
+
+		auto end = std::chrono::high_resolution_clock::now();
+		double frameTime = std::chrono::duration<double, std::milli>(end - start).count();
+		if (f == 0 || frameTime < result.frameTime)
+		{
+			result.frameTime = frameTime;
+			result.buildTime = std::chrono::duration<double, std::milli>(built - start).count();
+		}
+	}
+	result.indices = clusters.getIndicesNum();
+
+	result.image.resize(WIDTH * HEIGHT * 4);
+	glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, result.image.data());
+	frameConstants.release();
+	return result;
+}
+
+static void printUsage()
+{
+	std::cout << "usage: LightBenchmark [--lights 256] [--frames 5] [--quadratic 300] [--font file] [--shaders dir]" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, BenchmarkOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing the value of " << arg << std::endl;
+			return false;
+		}
+		std::string value = argv[++i];
+
+		if (arg == "--lights")
+			options.lights = std::strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--frames")
+			options.frames = std::strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--quadratic")
+			options.quadratic = std::strtof(value.c_str(), nullptr);
+		else if (arg == "--font")
+			options.fontFile = value;
+		else if (arg == "--shaders")
+			options.shaderDir = value;
+		else
+		{
+			std::cerr << "Unknown option " << arg << std::endl;
+			return false;
+		}
+	}
+	return options.lights > 0 && options.frames > 0 && options.quadratic >= 0.0f;
+}
+
+int main(int argc, char **argv)
+{
+	BenchmarkOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return 1;
+	}
+
+	//the window is never shown, it only holds the context
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "LightBenchmark", nullptr, nullptr);
+	if (window == nullptr)
+	{
+		std::cerr << "Failed to create GLFW window!" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cerr << "Failed to init glad!" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+	std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << std::endl;
+
+	//the offscreen framebuffer
+	GLuint fbo, renderbuffers[2];
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glGenRenderbuffers(2, renderbuffers);
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, WIDTH, HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, WIDTH, HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "Failed to create the framebuffer!" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+	glViewport(0, 0, WIDTH, HEIGHT);
+	glClearColor(1.0, 1.0, 1.0, 1.0);
+	glEnable(GL_DEPTH_TEST);
+
+	//24 lines of text fill the view
+	FontRegistry fonts;
+	FontFace *font = fonts.getFace(options.fontFile);
+	if (font == nullptr)
+	{
+		std::cerr << "Failed to load font " << options.fontFile << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+	GlyphMeshCache meshCache;
+	GlyphMeshStore glyphStore;
+	TextBatch wall(glyphStore);
+	for (int row = 0; row < 24; ++row)
+		addText(wall, glyphStore, meshCache, font, "0123456789 ABCDEFGHIJ 0123456789 KLMNOPQRST",
+			glm::vec3(-2.9f, -2.0f + row * 0.17f, 0.0f), 0.0055f);
+
+	ShaderCache shaders;
+	std::string vert = options.shaderDir + "text3D.vert", frag = options.shaderDir + "text3D.frag";
+	Shader *textShaders[2] =
+	{
+		&shaders.get(vert, frag, { { "SPOT_LIGHTS", "0" } }),
+		&shaders.get(vert, frag, { { "SPOT_LIGHTS", "1" } })
+	};
+	for (int i = 0; i < 2; ++i)
+	{
+		Shader &textShader = *textShaders[i];
+		textShader.use();
+		textShader.setUniformVec3("material.ambient", glm::vec3(1.0f, 1.0f, 0.0f));
+		textShader.setUniformVec3("material.diffuse", glm::vec3(1.0f, 1.0f, 0.0f));
+		textShader.setUniformVec3("material.specular", glm::vec3(0.5f, 0.5f, 0.5f));
+		textShader.setUniformFloat("material.shininess", 500.0f);
+	}
+
+	std::vector<LightBlock> lights = createLights(options);
+	std::cout << wall.getInstancesNum() << " glyph instances, " << lights.size() << " lights of radius " << lights[0].position.w
+		<< ", " << WIDTH << "x" << HEIGHT << ", best of " << options.frames << " frames" << std::endl;
+
+	//one cluster holds every light in the view, which is the cost of the lights without clusters
+	LightClusters single(1, 1, 1), clustered;
+	ModeResult results[2] =
+	{
+		runMode(single, lights, textShaders, wall, options),
+		runMode(clustered, lights, textShaders, wall, options)
+	};
+	const char *names[2] = { "  one cluster:      ", "  clusters 16x9x24: " };
+	for (int i = 0; i < 2; ++i)
+		std::cout << names[i] << results[i].frameTime << " ms per frame(cluster build " << results[i].buildTime << " ms), "
+			<< results[i].indices << " light indices" << std::endl;
+	std::cout << "  speedup " << results[0].frameTime / results[1].frameTime << "x" << std::endl;
+
+	size_t different = 0;
+	int maxDifference = 0;
+	for (size_t i = 0; i < results[0].image.size(); ++i)
+	{
+		int d = std::abs(results[0].image[i] - results[1].image[i]);
+		if (d > 0) ++different;
+		maxDifference = std::max(maxDifference, d);
+	}
+	std::cout << "  " << different << " channels differ between the images, by " << maxDifference << " steps at most" << std::endl;
+
+	single.release();
+	clustered.release();
+	wall.release();
+	glyphStore.release();
+	shaders.release();
+	glDeleteRenderbuffers(2, renderbuffers);
+	glDeleteFramebuffers(1, &fbo);
+	glfwTerminate();
+
+	return different ? 2 : 0;
+}
@@ -0,0 +1,362 @@
+//bake the 3D meshes of a whole set of characters to a glyph pack
+//
+//usage: GlyphBaker <font file> <output.t3gp> [options]
+//    --range U+4E00-U+9FA5   add a range of code points, can be given many times
+//    --charset <file>        add the characters of a charset file(e.g. charsets/gb2312.txt)
+//    --depth <float>         extrusion depth, 3.0 by default
+//    --size <pixels>         pixel size of the face, 24 by default
+//    --tolerance <float>     Bezier flattening tolerance in 1/64 pixel
+//    --crease <degrees>      crease angle of the wall normals, 0 gives flat walls
+//    --face <index>          face index of the font file, 0 by default
+//    --threads <n>           worker threads, all cores by default
+//
+//every baked glyph is decoded again and checked against the error bounds of the quantized vertex format
+//
+//a charset file is UTF-8 text, lines start with '#' are comments, lines start with "U+" are code points or ranges,
+//every character of the other lines is baked
+#include <FontRegistry.h>
+#include <FreeTypeFont.h>
+#include <Tessellator.h>
+#include <GlyphMeshCache.h>
+#include <GlyphPack.h>
+#include <MeshOptimizer.h>
+#include <VertexQuantizer.h>
+
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+
+struct BakeOptions
+{
+	std::string fontFile;
+	std::string output;
+	std::set<FT_ULong> charcodes;
+	float depth = 3.0f;
+	FT_UInt pixelSize = 24;
+	float tolerance = FreeType::DefaultTolerance;
+	float creaseAngle = DefaultCreaseAngle;
+	FT_Long faceIndex = 0;
+	unsigned int threads = 0;
+};
+
+struct BakeFailure
+{
+	FT_UInt glyphIndex;
+	std::string reason;
+};
+
+//the result of a glyph, reason is nullptr if it is baked
+struct BakedGlyph
+{
+	GlyphPackGlyph packed;
+	const char *reason;
+};
+
+//the last code point of unicode, the ranges beyond it are rejected so the loops over a range can't wrap around
+static const FT_ULong MaxCodePoint = 0x10FFFF;
+
+//parse "U+4E00", "U+4E00-U+9FA5" or "0x4E00-0x9FA5"
+static bool parseRange(const std::string &text, FT_ULong &first, FT_ULong &last)
+{
+	auto parseCode = [](const std::string &s, FT_ULong &code)
+	{
+		size_t p = 0;
+		if (s.compare(0, 2, "U+") == 0 || s.compare(0, 2, "u+") == 0 || s.compare(0, 2, "0x") == 0 || s.compare(0, 2, "0X") == 0)
+			p = 2;
+		if (p >= s.size()) return false;
+		char *end = nullptr;
+		code = std::strtoul(s.c_str() + p, &end, 16);
+		return *end == '\0' && code <= MaxCodePoint;
+	};
+
+	size_t dash = text.find('-');
+	if (!parseCode(text.substr(0, dash), first)) return false;
+	if (dash == std::string::npos)
+	{
+		last = first;
+		return true;
+	}
+	return parseCode(text.substr(dash + 1), last) && first <= last;
+}
+
+//append the code points of an UTF-8 string
+static void decodeUTF8(const std::string &text, std::set<FT_ULong> &charcodes)
+{
+	for (size_t i = 0; i < text.size();)
+	{
+		unsigned char c = text[i];
+		unsigned int len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 0;
+		if (len == 0 || i + len > text.size())
+		{
+			++i;
+			continue;
+		}
+
+		FT_ULong code = len == 1 ? c : c & (0xFF >> (len + 1));
+		for (unsigned int k = 1; k < len; ++k)
+			code = (code << 6) | (text[i + k] & 0x3F);
+		i += len;
+
+		if (code > ' ' && code != 0xFEFF)
+			charcodes.insert(code);
+	}
+}
+
+static bool loadCharset(const std::string &path, std::set<FT_ULong> &charcodes)
+{
+	std::ifstream fin(path, std::ios::binary);
+	if (!fin)
+	{
+		std::cerr << "Failed to open charset file " << path << std::endl;
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(fin, line))
+	{
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.empty() || line[0] == '#') continue;
+
+		FT_ULong first, last;
+		if (line.compare(0, 2, "U+") == 0)
+		{
+			if (!parseRange(line, first, last))
+			{
+				std::cerr << "Invalid code point range in " << path << ": " << line << std::endl;
+				return false;
+			}
+			for (FT_ULong c = first; c <= last; ++c)
+				charcodes.insert(c);
+		}
+		else
+			decodeUTF8(line, charcodes);
+	}
+	return true;
+}
+
+static void printUsage()
+{
+	std::cout << "usage: GlyphBaker <font file> <output.t3gp> [--range U+XXXX-U+YYYY] [--charset file]\n"
+		<< "                  [--depth 3.0] [--size 24] [--tolerance " << FreeType::DefaultTolerance << "]\n"
+		<< "                  [--crease " << DefaultCreaseAngle << "] [--face 0] [--threads n]" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, BakeOptions &options)
+{
+	if (argc < 3) return false;
+	options.fontFile = argv[1];
+	options.output = argv[2];
+
+	for (int i = 3; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing the value of " << arg << std::endl;
+			return false;
+		}
+		std::string value = argv[++i];
+
+		if (arg == "--range")
+		{
+			FT_ULong first, last;
+			if (!parseRange(value, first, last))
+			{
+				std::cerr << "Invalid code point range " << value << std::endl;
+				return false;
+			}
+			for (FT_ULong c = first; c <= last; ++c)
+				options.charcodes.insert(c);
+		}
+		else if (arg == "--charset")
+		{
+			if (!loadCharset(value, options.charcodes)) return false;
+		}
+		else if (arg == "--depth")
+			options.depth = std::strtof(value.c_str(), nullptr);
+		else if (arg == "--size")
+			options.pixelSize = std::strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--tolerance")
+			options.tolerance = std::strtof(value.c_str(), nullptr);
+		else if (arg == "--crease")
+			options.creaseAngle = std::strtof(value.c_str(), nullptr);
+		else if (arg == "--face")
+			options.faceIndex = std::strtol(value.c_str(), nullptr, 10);
+		else if (arg == "--threads")
+			options.threads = std::strtoul(value.c_str(), nullptr, 10);
+		else
+		{
+			std::cerr << "Unknown option " << arg << std::endl;
+			return false;
+		}
+	}
+
+	if (options.charcodes.empty())
+	{
+		std::cerr << "No characters to bake, use --range or --charset" << std::endl;
+		return false;
+	}
+	return options.pixelSize > 0 && options.tolerance > 0.0f && options.depth > 0.0f && options.creaseAngle >= 0.0f;
+}
+
+int main(int argc, char **argv)
+{
+	BakeOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return 1;
+	}
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	FontRegistry fonts;
+	FontFace *font = fonts.getFace(options.fontFile, options.faceIndex, options.pixelSize);
+	if (!font)
+	{
+		std::cerr << "Failed to load font " << options.fontFile << std::endl;
+		return 1;
+	}
+
+	//the characters sharing a glyph are baked once
+	std::map<FT_UInt, std::vector<FT_ULong>> glyphChars;
+	std::vector<FT_ULong> missing;
+	for (FT_ULong c : options.charcodes)
+	{
+		FT_UInt index = font->glyphIndex(c);
+		if (index == 0)
+			missing.push_back(c);
+		else
+			glyphChars[index].push_back(c);
+	}
+	std::vector<FT_UInt> glyphs;
+	for (const auto &g : glyphChars)
+		glyphs.push_back(g.first);
+
+	unsigned int numThreads = options.threads ? options.threads : std::thread::hardware_concurrency();
+	if (numThreads == 0) numThreads = 1;
+	if (numThreads > glyphs.size()) numThreads = glyphs.size() ? glyphs.size() : 1;
+
+	//every glyph has its own slot, so the workers don't wait for each other to store a result
+	std::vector<BakedGlyph> baked(glyphs.size());
+	VertexCacheStats cacheBefore, cacheAfter;
+	QuantizationError maxError{ 0.0f, 0.0f };
+	std::mutex statsMutex;
+	std::atomic<size_t> next(0);
+
+	//every worker has its own face over the shared mapping of the font file and its own tessellator,
+	//it takes the next glyph when it is free
+	auto work = [&]()
+	{
+		FontFace *face = fonts.createFace(options.fontFile, options.faceIndex, options.pixelSize);
+		Tessellator ts;
+		for (size_t i = next++; i < glyphs.size(); i = next++)
+		{
+			FT_UInt index = glyphs[i];
+			GlyphMesh mesh;
+			GlyphPackGlyph &packed = baked[i].packed;
+			const char *&reason = baked[i].reason;
+			reason = nullptr;
+			VertexCacheStats before, after;
+			QuantizationError error{ 0.0f, 0.0f };
+
+			FreeTypeFont ft(face, index, options.tolerance);
+			if (!ft.isValid())
+				reason = "failed to load the outline";
+			else
+			{
+				mesh.glyph = ft.getGlyph3D();
+				mesh.advanceX = ft.advanceX();
+				if (!computeGlyphGeometry(mesh.glyph, options.depth, ts, options.creaseAngle))
+					reason = "failed to tessellate the outline";
+				else
+				{
+					optimizeGlyphMesh(mesh.glyph, FORSYTH, &before, &after);
+					packed = GlyphPackWriter::convert(index, mesh);
+
+					//decode the vertices the way the renderer does
+					QuantizationBounds bounds = GlyphPack::bounds(packed.entry);
+					error = measureQuantizationError(mesh.glyph._vertices, mesh.glyph.getNormalArray(), packed.vertices.data(), bounds);
+					QuantizationError limit = maxQuantizationError(bounds);
+					if (error.position > limit.position || error.normalAngle > limit.normalAngle)
+						reason = "the quantization error is out of bounds";
+				}
+			}
+
+			if (reason) continue;
+			std::lock_guard<std::mutex> lock(statsMutex);
+			cacheBefore.add(before);
+			cacheAfter.add(after);
+			maxError.position = std::max(maxError.position, error.position);
+			maxError.normalAngle = std::max(maxError.normalAngle, error.normalAngle);
+		}
+		fonts.releaseFace(face);
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned int t = 0; t < numThreads; ++t)
+		workers.emplace_back(work);
+	for (auto &w : workers)
+		w.join();
+
+	//the glyphs are added in the order of their indices, not in the order the workers finished them,
+	//so the same input always gives the same file
+	GlyphPackWriter writer(options.pixelSize, options.tolerance, options.depth, options.creaseAngle);
+	std::vector<BakeFailure> failures;
+	size_t numVertices = 0;
+	for (size_t i = 0; i < glyphs.size(); ++i)
+	{
+		FT_UInt index = glyphs[i];
+		if (baked[i].reason)
+		{
+			failures.push_back({ index, baked[i].reason });
+			continue;
+		}
+		numVertices += baked[i].packed.vertices.size();
+		const std::vector<FT_ULong> &chars = glyphChars[index];
+		writer.addGlyph(chars[0], baked[i].packed);
+		for (size_t k = 1; k < chars.size(); ++k)
+			writer.addChar(chars[k], index);
+		//the writer keeps its own copy
+		baked[i].packed = GlyphPackGlyph();
+	}
+
+	auto bakeTime = std::chrono::high_resolution_clock::now();
+
+	if (!writer.write(options.output))
+		return 1;
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	double bakeSeconds = std::chrono::duration<double>(bakeTime - startTime).count();
+	double totalSeconds = std::chrono::duration<double>(endTime - startTime).count();
+
+	//report
+	std::cout << std::hex << std::uppercase;
+	for (FT_ULong c : missing)
+		std::cout << "U+" << c << ": no glyph in the font" << std::endl;
+	for (const auto &f : failures)
+		for (FT_ULong c : glyphChars[f.glyphIndex])
+			std::cout << "U+" << c << " (glyph " << std::dec << f.glyphIndex << std::hex << "): " << f.reason << std::endl;
+	std::cout << std::dec << std::nouppercase;
+
+	std::cout << "Baked " << writer.getGlyphsNum() << " of " << glyphs.size() << " glyphs for "
+		<< options.charcodes.size() << " characters, " << missing.size() << " missing, "
+		<< failures.size() << " failed" << std::endl;
+	std::cout << numThreads << " threads, " << bakeSeconds * 1000.0 << " ms, "
+		<< (bakeSeconds > 0.0 ? writer.getGlyphsNum() / bakeSeconds : 0.0) << " glyphs/s, "
+		<< totalSeconds * 1000.0 << " ms with writing " << options.output << std::endl;
+	printVertexCacheStats(std::cout, "Baked meshes", cacheBefore, cacheAfter);
+	std::cout << "Quantized " << numVertices << " vertices to " << sizeof(GlyphPackVertex) << " bytes, max error "
+		<< maxError.position << " in position, " << maxError.normalAngle << " degrees in normal" << std::endl;
+
+	return failures.empty() ? 0 : 2;
+}
@@ -0,0 +1,244 @@
+//check the round trip of the 12 bytes quantized vertex format on the CPU
+//
+//usage: QuantizationCheck [font files] [options]
+//    --depth <float>         extrusion depth, 3.0 by default
+//    --size <pixels>         pixel size of the faces, 24 by default
+//    --crease <degrees>      crease angle of the wall normals, 0 gives flat walls
+//
+//every glyph of the fonts(../fonts/STXINWEI.TTF and ../fonts/arial.ttf by default) is built, quantized by quantizeGlyph,
+//decoded again and its errors are compared with maxQuantizationError,
+//then the edge cases the fonts may not hit are checked: bounds with a zero scale on some axes,
+//the axis aligned and diagonal normals and a dense set of normals over the whole sphere
+//
+//the program returns 0 if every error is in its bounds, 2 otherwise
+#include <FontRegistry.h>
+#include <FreeTypeFont.h>
+#include <Tessellator.h>
+#include <VertexQuantizer.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+struct CheckOptions
+{
+	std::vector<std::string> fontFiles;
+	float depth = 3.0f;
+	FT_UInt pixelSize = 24;
+	float creaseAngle = DefaultCreaseAngle;
+};
+
+//the errors of a set of meshes and how far they are from their bounds
+struct CheckResult
+{
+	unsigned int meshes = 0;
+	unsigned int skipped = 0;
+	unsigned int failed = 0;
+	size_t vertices = 0;
+	QuantizationError maxError{ 0.0f, 0.0f };
+	float worstPositionRatio = 0.0f;    //the largest error / bound of all meshes
+
+	void add(const Vec3Array &positions, const Vec3Array &normals, const std::vector<QuantizedVertex> &quantized,
+		const QuantizationBounds &bounds)
+	{
+		QuantizationError error = measureQuantizationError(positions, normals, quantized.data(), bounds);
+		QuantizationError limit = maxQuantizationError(bounds);
+		++meshes;
+		vertices += quantized.size();
+		if (quantized.size() != positions.size() || error.position > limit.position || error.normalAngle > limit.normalAngle)
+			++failed;
+		maxError.position = std::max(maxError.position, error.position);
+		maxError.normalAngle = std::max(maxError.normalAngle, error.normalAngle);
+		if (limit.position > 0.0f)
+			worstPositionRatio = std::max(worstPositionRatio, error.position / limit.position);
+	}
+
+	void print(const std::string &name) const
+	{
+		std::cout << name << ": " << meshes << " meshes, " << vertices << " vertices, ";
+		if (skipped) std::cout << skipped << " skipped, ";
+		std::cout << "max error " << maxError.position << " in position(" << worstPositionRatio * 100.0f << "% of the bound), "
+			<< maxError.normalAngle << " degrees in normal, " << (failed ? std::to_string(failed) + " FAILED" : "ok") << std::endl;
+	}
+};
+
+//quantize a vertex array with its own bounds the way quantizeGlyph does
+static void checkVertices(const Vec3Array &positions, const Vec3Array &normals, CheckResult &result)
+{
+	QuantizationBounds bounds = computeQuantizationBounds(positions);
+	std::vector<QuantizedVertex> quantized;
+	for (size_t i = 0; i < positions.size(); ++i)
+		quantized.push_back(quantizeVertex(positions[i], normals[i], bounds));
+	result.add(positions, normals, quantized, bounds);
+}
+
+static bool checkFont(FontRegistry &fonts, const std::string &font_file, const CheckOptions &options)
+{
+	FontFace *font = fonts.getFace(font_file, 0, options.pixelSize);
+	if (!font)
+	{
+		std::cerr << "Failed to load font " << font_file << std::endl;
+		return false;
+	}
+
+	CheckResult result;
+	Tessellator ts;
+	std::vector<QuantizedVertex> quantized;
+	for (FT_Long index = 1; index < font->face->num_glyphs; ++index)
+	{
+		FreeTypeFont ft(font, index);
+		if (!ft.isValid())
+		{
+			++result.skipped;
+			continue;
+		}
+		Glyph3D glyph = ft.getGlyph3D();
+		//a glyph without outline(e.g. a space) has no mesh
+		if (!computeGlyphGeometry(glyph, options.depth, ts, options.creaseAngle) || glyph._vertices.empty())
+		{
+			++result.skipped;
+			continue;
+		}
+		QuantizationBounds bounds = quantizeGlyph(glyph, quantized);
+		result.add(glyph._vertices, glyph.getNormalArray(), quantized, bounds);
+	}
+	result.print(font_file);
+	return result.failed == 0;
+}
+
+//meshes whose bounds have a zero scale on some axes, the flat axes must decode to the offset exactly
+static bool checkFlatBounds()
+{
+	const glm::vec3 up(0.0f, 0.0f, 1.0f);
+	CheckResult result;
+
+	//a single vertex, all axes are flat
+	checkVertices({ glm::vec3(12.5f, -3.25f, 7.0f) }, { up }, result);
+	//a front face without extrusion, z is flat
+	checkVertices({ glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(640.0f, 0.0f, 0.0f), glm::vec3(320.0f, 896.0f, 0.0f) }, { up, up, up }, result);
+	//a horizontal stroke, y and z are flat, far from the origin
+	checkVertices({ glm::vec3(10000.0f, 500.0f, -3.0f), glm::vec3(10640.0f, 500.0f, -3.0f) }, { up, up }, result);
+	//a vertical line on the wall, x and y are flat
+	checkVertices({ glm::vec3(-7.0f, 11.0f, 0.0f), glm::vec3(-7.0f, 11.0f, -3.0f) }, { up, up }, result);
+
+	//the flat axes are checked exactly, the bounds allow a few float roundings only
+	unsigned int inexact = 0;
+	Vec3Array points = { glm::vec3(12.5f, -3.25f, 7.0f), glm::vec3(-7.0f, 11.0f, -3.0f) };
+	for (const auto &p : points)
+	{
+		QuantizationBounds bounds{ p, glm::vec3(0.0f) };
+		if (dequantizePosition(quantizeVertex(p, up, bounds), bounds) != p)
+			++inexact;
+	}
+	result.failed += inexact;
+	result.print("Flat bounds");
+	return result.failed == 0;
+}
+
+static bool checkNormals()
+{
+	const glm::vec3 origin(0.0f);
+
+	//the axes and the diagonals of the cube, the diagonals of the octants lie on the folds of the octahedral map
+	Vec3Array axes, diagonals;
+	for (int k = 0; k < 3; ++k)
+		for (float s : { 1.0f, -1.0f })
+		{
+			glm::vec3 n(0.0f);
+			n[k] = s;
+			axes.push_back(n);
+		}
+	for (int x = -1; x <= 1; ++x)
+		for (int y = -1; y <= 1; ++y)
+			for (int z = -1; z <= 1; ++z)
+			{
+				int nonZero = (x != 0) + (y != 0) + (z != 0);
+				if (nonZero >= 2)
+					diagonals.push_back(glm::normalize(glm::vec3(x, y, z)));
+			}
+
+	CheckResult axisResult, diagonalResult, sphereResult;
+	checkVertices(Vec3Array(axes.size(), origin), axes, axisResult);
+	checkVertices(Vec3Array(diagonals.size(), origin), diagonals, diagonalResult);
+
+	//a fibonacci spiral covers the sphere evenly, every 4th normal is moved to the fold at z = 0
+	const unsigned int numSamples = 200000;
+	const float goldenAngle = 3.14159265f * (3.0f - std::sqrt(5.0f));
+	Vec3Array sphere(numSamples);
+	for (unsigned int i = 0; i < numSamples; ++i)
+	{
+		float z = 1.0f - 2.0f * (i + 0.5f) / numSamples;
+		float r = std::sqrt(1.0f - z * z);
+		float a = goldenAngle * i;
+		sphere[i] = i % 4 == 0 ? glm::vec3(std::cos(a), std::sin(a), 0.0f) : glm::vec3(r * std::cos(a), r * std::sin(a), z);
+	}
+	checkVertices(Vec3Array(numSamples, origin), sphere, sphereResult);
+
+	axisResult.print("Axis aligned normals");
+	diagonalResult.print("Diagonal normals");
+	sphereResult.print("Sphere normals");
+	return axisResult.failed == 0 && diagonalResult.failed == 0 && sphereResult.failed == 0;
+}
+
+static void printUsage()
+{
+	std::cout << "usage: QuantizationCheck [font files] [--depth 3.0] [--size 24] [--crease " << DefaultCreaseAngle << "]" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, CheckOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg.compare(0, 2, "--") != 0)
+		{
+			options.fontFiles.push_back(arg);
+			continue;
+		}
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing the value of " << arg << std::endl;
+			return false;
+		}
+		std::string value = argv[++i];
+
+		if (arg == "--depth")
+			options.depth = std::strtof(value.c_str(), nullptr);
+		else if (arg == "--size")
+			options.pixelSize = std::strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--crease")
+			options.creaseAngle = std::strtof(value.c_str(), nullptr);
+		else
+		{
+			std::cerr << "Unknown option " << arg << std::endl;
+			return false;
+		}
+	}
+
+	if (options.fontFiles.empty())
+		options.fontFiles = { "../fonts/STXINWEI.TTF", "../fonts/arial.ttf" };
+	return options.pixelSize > 0 && options.depth > 0.0f && options.creaseAngle >= 0.0f;
+}
+
+int main(int argc, char **argv)
+{
+	CheckOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return 1;
+	}
+
+	bool ok = true;
+	FontRegistry fonts;
+	for (const auto &f : options.fontFiles)
+		ok = checkFont(fonts, f, options) && ok;
+	ok = checkFlatBounds() && ok;
+	ok = checkNormals() && ok;
+
+	std::cout << (ok ? "All quantization errors are in their bounds" : "Some quantization errors are out of their bounds") << std::endl;
+	return ok ? 0 : 2;
+}
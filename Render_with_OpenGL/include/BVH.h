@@ -0,0 +1,122 @@
+#pragma once
+
+#include <glm\glm.hpp>
+
+#include <Glyph3D.h>
+#include <Frustum.h>
+
+#include <vector>
+#include <algorithm>
+
+//a bounding volume hierarchy over the boxes of items, e.g. the glyph instances of a TextBatch
+//the nodes are in depth first order, the left child of a node follows it and every node covers a range of the sorted items,
+//so a node inside the frustum gives all its items without visiting its children
+class BVH
+{
+public:
+	static const unsigned int LeafSize = 4;
+
+	//build the tree over items, boxes[i] is the box of items[i]
+	void build(const std::vector<BoundingBox> &boxes, const std::vector<unsigned int> &items);
+	//append the items whose boxes intersect the frustum to visible, return the number of box tests
+	unsigned int cull(const Frustum &frustum, std::vector<unsigned int> &visible) const;
+
+	unsigned int getNodesNum() const { return _nodes.size(); }
+	BoundingBox bounds() const { return _nodes.empty() ? BoundingBox() : _nodes[0].bounds; }
+
+private:
+	struct Node
+	{
+		BoundingBox bounds;
+		unsigned int first;     //the range of the items under the node
+		unsigned int count;
+		unsigned int right;     //the index of the right child, 0 for a leaf
+	};
+
+	unsigned int buildNode(unsigned int first, unsigned int count);
+
+	std::vector<Node> _nodes;
+	std::vector<unsigned int> _order;    //the indices of the items sorted so a node covers a range of them
+	std::vector<unsigned int> _items;
+	std::vector<BoundingBox> _boxes;
+	std::vector<glm::vec3> _centers;
+};
+
+void BVH::build(const std::vector<BoundingBox> &boxes, const std::vector<unsigned int> &items)
+{
+	_nodes.clear();
+	_items = items;
+	_boxes = boxes;
+	_centers.resize(boxes.size());
+	_order.resize(boxes.size());
+	for (size_t i = 0; i < boxes.size(); ++i)
+	{
+		_centers[i] = boxes[i].center();
+		_order[i] = i;
+	}
+	if (!_items.empty())
+		buildNode(0, _items.size());
+}
+
+unsigned int BVH::buildNode(unsigned int first, unsigned int count)
+{
+	unsigned int index = _nodes.size();
+	_nodes.push_back({ BoundingBox(), first, count, 0 });
+	BoundingBox bounds, centers;
+	for (unsigned int i = first; i < first + count; ++i)
+	{
+		bounds.expand(_boxes[_order[i]]);
+		centers.expand(_centers[_order[i]]);
+	}
+	_nodes[index].bounds = bounds;
+	if (count <= LeafSize) return index;
+
+	//split at the median center along the longest axis of the centers
+	glm::vec3 extent = centers.max - centers.min;
+	int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+	unsigned int half = count / 2;
+	std::nth_element(_order.begin() + first, _order.begin() + first + half, _order.begin() + first + count,
+		[this, axis](unsigned int a, unsigned int b) { return _centers[a][axis] < _centers[b][axis]; });
+
+	buildNode(first, half);
+	unsigned int right = buildNode(first + half, count - half);
+	_nodes[index].right = right;
+	return index;
+}
+
+unsigned int BVH::cull(const Frustum &frustum, std::vector<unsigned int> &visible) const
+{
+	if (_nodes.empty()) return 0;
+	unsigned int tests = 0;
+	unsigned int stack[64];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0)
+	{
+		const Node &node = _nodes[stack[--top]];
+		++tests;
+		Frustum::Result result = frustum.test(node.bounds);
+		if (result == Frustum::Outside) continue;
+		if (result == Frustum::Inside)
+		{
+			for (unsigned int i = node.first; i < node.first + node.count; ++i)
+				visible.push_back(_items[_order[i]]);
+			continue;
+		}
+		if (node.right == 0)
+		{
+			//a leaf crossing the frustum tests the boxes of its items
+			for (unsigned int i = node.first; i < node.first + node.count; ++i)
+			{
+				++tests;
+				if (frustum.test(_boxes[_order[i]]) != Frustum::Outside)
+					visible.push_back(_items[_order[i]]);
+			}
+			continue;
+		}
+		unsigned int self = &node - _nodes.data();
+		stack[top++] = node.right;
+		stack[top++] = self + 1;
+	}
+	return tests;
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <glad\glad.h>
+#include <glm\glm.hpp>
+
+#include <Light.h>
+#include <Shader.h>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+//the std140 layout of the Matrix block of text3D.vert
+struct MatrixBlock
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+};
+static_assert(sizeof(MatrixBlock) == 128, "MatrixBlock must match std140");
+
+//the std140 layout of the Lights block of text3D.frag, the point lights and spot lights are in the buffers of LightClusters
+struct LightsBlock
+{
+	DirLightBlock dirLight;
+	glm::uvec4 clusterGrid;     //the clusters along x, y and z
+	glm::vec4 clusterParams;    //the clusters per pixel along x and y, the scale and bias from log(view depth) to the slice
+};
+static_assert(sizeof(LightsBlock) == 96, "LightsBlock must match std140");
+
+//the per frame uniform blocks: Matrix at binding 0 and Lights at binding 1
+//every frame writes both blocks to its own region of a ring of RingSize regions and binds that region,
+//so the CPU writes one region while the GPU still reads the regions of the frames before
+//with opengl 4.4 the buffer is mapped persistently and a fence guards every region,
+//otherwise a region is written by one glBufferSubData, the buffer is never specified again after its creation
+template <typename Lights>
+class FrameConstants
+{
+public:
+	static const unsigned int RingSize = 3;
+	static const GLuint MatrixBinding = 0;
+	static const GLuint LightsBinding = 1;
+
+	MatrixBlock matrix;
+	Lights lights;
+
+	FrameConstants();
+
+	//write matrix and lights to the next region and bind it, the buffer is created at the first upload
+	void upload();
+	//fence the region after the draws of the frame
+	void endFrame();
+	void release();
+
+	//compare the blocks with the blocks reflected from a program, print an error for every difference
+	bool checkLayout(const Shader &shader) const;
+	bool isPersistent() const { return _mapped != nullptr; }
+	//the uploads which had to wait for the GPU to finish a region
+	unsigned long long getStalls() const { return _stalls; }
+
+private:
+	void create();
+
+	GLuint _buffer;
+	unsigned char *_mapped;            //the persistent mapping of the whole ring
+	std::vector<unsigned char> _staging;
+	GLsync _fences[RingSize];
+	unsigned int _region;
+	GLintptr _lightsOffset;            //the offset of Lights in a region
+	GLintptr _regionSize;
+	unsigned long long _stalls;
+};
+
+template <typename Lights>
+FrameConstants<Lights>::FrameConstants() :
+matrix(),
+lights(),
+_buffer(0),
+_mapped(nullptr),
+_region(0),
+_lightsOffset(0),
+_regionSize(0),
+_stalls(0)
+{
+	for (auto &f : _fences)
+		f = nullptr;
+}
+
+template <typename Lights>
+void FrameConstants<Lights>::create()
+{
+	//the offset of a bound range must be a multiple of the alignment
+	GLint alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	auto align = [alignment](GLintptr offset) { return (offset + alignment - 1) / alignment * alignment; };
+	_lightsOffset = align(sizeof(MatrixBlock));
+	_regionSize = align(_lightsOffset + sizeof(Lights));
+
+	glGenBuffers(1, &_buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+	if (GLAD_GL_VERSION_4_4)
+	{
+		//coherent: the writes are seen by the GPU without an explicit flush
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_UNIFORM_BUFFER, _regionSize * RingSize, nullptr, flags);
+		_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, _regionSize * RingSize, flags));
+		if (!_mapped)
+		{
+			//the immutable storage takes neither glBufferData nor glBufferSubData, start over with a new buffer
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			glDeleteBuffers(1, &_buffer);
+			glGenBuffers(1, &_buffer);
+			glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+		}
+	}
+	if (!_mapped)
+	{
+		glBufferData(GL_UNIFORM_BUFFER, _regionSize * RingSize, nullptr, GL_DYNAMIC_DRAW);
+		_staging.assign(_regionSize, 0);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+template <typename Lights>
+void FrameConstants<Lights>::upload()
+{
+	if (!_buffer)
+		create();
+
+	GLintptr offset = _region * _regionSize;
+	if (_mapped)
+	{
+		//wait until the GPU has read the region written RingSize frames before
+		if (GLsync fence = _fences[_region])
+		{
+			if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+			{
+				++_stalls;
+				while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+				{
+				}
+			}
+			glDeleteSync(fence);
+			_fences[_region] = nullptr;
+		}
+		std::memcpy(_mapped + offset, &matrix, sizeof(MatrixBlock));
+		std::memcpy(_mapped + offset + _lightsOffset, &lights, sizeof(Lights));
+	}
+	else
+	{
+		std::memcpy(&_staging[0], &matrix, sizeof(MatrixBlock));
+		std::memcpy(&_staging[_lightsOffset], &lights, sizeof(Lights));
+		glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, offset, _regionSize, _staging.data());
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	glBindBufferRange(GL_UNIFORM_BUFFER, MatrixBinding, _buffer, offset, sizeof(MatrixBlock));
+	glBindBufferRange(GL_UNIFORM_BUFFER, LightsBinding, _buffer, offset + _lightsOffset, sizeof(Lights));
+}
+
+template <typename Lights>
+void FrameConstants<Lights>::endFrame()
+{
+	if (!_buffer) return;
+	if (_mapped)
+		_fences[_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_region = (_region + 1) % RingSize;
+}
+
+template <typename Lights>
+void FrameConstants<Lights>::release()
+{
+	if (!_buffer) return;
+	for (auto &f : _fences)
+	{
+		if (f) glDeleteSync(f);
+		f = nullptr;
+	}
+	if (_mapped)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		_mapped = nullptr;
+	}
+	glDeleteBuffers(1, &_buffer);
+	_buffer = 0;
+	_region = 0;
+	_staging.clear();
+}
+
+template <typename Lights>
+bool FrameConstants<Lights>::checkLayout(const Shader &shader) const
+{
+	bool ok = true;
+	auto check = [&shader, &ok](const char *name, GLint binding, size_t size)
+	{
+		const UniformBlockInfo *info = shader.findBlock(name);
+		if (info == nullptr) return;
+		if (info->binding != binding || info->dataSize != GLint(size))
+		{
+			std::cerr << "ERRO::FRAME_CONSTANTS::BLOCK_MISMATCH " << name << ": binding " << info->binding << ", "
+				<< info->dataSize << " bytes in the program, binding " << binding << ", " << size << " bytes in C++" << std::endl;
+			ok = false;
+		}
+	};
+	check("Matrix", MatrixBinding, sizeof(MatrixBlock));
+	check("Lights", LightsBinding, sizeof(Lights));
+	return ok;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+
+#include <GLCallCounter.h>
+
+//the CPU time and the draw calls of the frames, printed as averages every interval
+//the CPU time of a frame is measured from beginFrame to endFrame, so the wait in the buffer swap is not counted
+//the GL calls between beginFrame and endFrame are counted too once GLCallCounter is installed
+class FrameStats
+{
+public:
+	explicit FrameStats(double report_interval = 2.0);
+
+	void beginFrame();
+	void endFrame();
+	void addDrawCalls(unsigned int n) { _drawCalls += n; }
+
+	//print and restart the averages once the interval passed since the last report
+	void report(std::ostream &os);
+	void print(std::ostream &os) const;
+
+private:
+	using Clock = std::chrono::high_resolution_clock;
+
+	double _interval;
+	Clock::time_point _lastReport;
+	Clock::time_point _frameStart;
+
+	unsigned long long _frames;
+	unsigned long long _drawCalls;
+	unsigned long long _glCalls;
+	unsigned long long _glCallsStart;   //GLCallCounter::total at beginFrame
+	double _cpuTime;        //seconds
+	double _maxCpuTime;
+};
+
+FrameStats::FrameStats(double report_interval) :
+_interval(report_interval),
+_lastReport(Clock::now()),
+_frames(0),
+_drawCalls(0),
+_glCalls(0),
+_glCallsStart(0),
+_cpuTime(0.0),
+_maxCpuTime(0.0)
+{
+}
+
+void FrameStats::beginFrame()
+{
+	_frameStart = Clock::now();
+	_glCallsStart = GLCallCounter::total();
+}
+
+void FrameStats::endFrame()
+{
+	double t = std::chrono::duration<double>(Clock::now() - _frameStart).count();
+	_cpuTime += t;
+	_maxCpuTime = std::max(_maxCpuTime, t);
+	_glCalls += GLCallCounter::total() - _glCallsStart;
+	++_frames;
+}
+
+void FrameStats::report(std::ostream &os)
+{
+	if (std::chrono::duration<double>(Clock::now() - _lastReport).count() < _interval) return;
+
+	print(os);
+	_lastReport = Clock::now();
+	_frames = _drawCalls = _glCalls = 0;
+	_cpuTime = _maxCpuTime = 0.0;
+}
+
+void FrameStats::print(std::ostream &os) const
+{
+	if (_frames == 0) return;
+	os << "Frames: " << _frames << ", " << double(_drawCalls) / _frames << " draw calls/frame, ";
+	if (_glCalls > 0)
+		os << double(_glCalls) / _frames << " GL calls/frame, ";
+	os << "CPU " << _cpuTime * 1000.0 / _frames << " ms/frame(max " << _maxCpuTime * 1000.0 << " ms)" << std::endl;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glm\glm.hpp>
+
+#include <Glyph3D.h>
+
+#include <cmath>
+
+//the 6 planes of a view frustum, extracted from projection * view, so the planes are in world space
+//a plane is (normal, d) with the normal pointing into the frustum, a point p is inside if dot(normal, p) + d >= 0
+class Frustum
+{
+public:
+	enum Result { Outside, Intersect, Inside };
+
+	glm::vec4 planes[6];    //left, right, bottom, top, near, far
+
+	Frustum() = default;
+	explicit Frustum(const glm::mat4 &projection_view);
+
+	//Outside if the box is behind a plane, Inside if it is in front of all planes
+	//a box near a corner of the frustum may be reported Intersect though it is outside, it is never culled by mistake
+	Result test(const BoundingBox &box) const;
+};
+
+Frustum::Frustum(const glm::mat4 &projection_view)
+{
+	//the rows of the matrix, glm is column major
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; ++i)
+		rows[i] = glm::vec4(projection_view[0][i], projection_view[1][i], projection_view[2][i], projection_view[3][i]);
+	for (int i = 0; i < 3; ++i)
+	{
+		planes[i * 2] = rows[3] + rows[i];
+		planes[i * 2 + 1] = rows[3] - rows[i];
+	}
+	for (auto &p : planes)
+		p /= glm::length(glm::vec3(p));
+}
+
+Frustum::Result Frustum::test(const BoundingBox &box) const
+{
+	Result result = Inside;
+	for (const auto &p : planes)
+	{
+		glm::vec3 n(p);
+		//the corner furthest along the normal and the corner furthest against it
+		glm::vec3 positive(n.x >= 0.0f ? box.max.x : box.min.x, n.y >= 0.0f ? box.max.y : box.min.y, n.z >= 0.0f ? box.max.z : box.min.z);
+		glm::vec3 negative(n.x >= 0.0f ? box.min.x : box.max.x, n.y >= 0.0f ? box.min.y : box.max.y, n.z >= 0.0f ? box.min.z : box.max.z);
+		if (glm::dot(n, positive) + p.w < 0.0f)
+			return Outside;
+		if (glm::dot(n, negative) + p.w < 0.0f)
+			result = Intersect;
+	}
+	return result;
+}
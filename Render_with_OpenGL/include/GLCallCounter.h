@@ -0,0 +1,132 @@
+#pragma once
+
+#include <glad\glad.h>
+
+#include <iostream>
+#include <vector>
+
+//count the calls of the GL functions used by the renderer
+//install() replaces the glad function pointers with counting wrappers which forward to the driver,
+//so every call through glad is counted without touching the call sites
+class GLCallCounter
+{
+public:
+	//hook the functions, call it once after gladLoadGLLoader
+	static void install();
+
+	//the calls since the last reset
+	static unsigned long long total();
+	static void reset();
+	//print the calls of every function since the last reset, averaged over frames
+	static void print(std::ostream &os, unsigned long long frames = 1);
+
+private:
+	struct Entry
+	{
+		const char *name;
+		unsigned long long *count;
+	};
+	static std::vector<Entry>& entries();
+
+	template <typename R, typename... Args>
+	struct Signature
+	{
+		template <R (APIENTRYP *Slot)(Args...)>
+		struct Hook
+		{
+			static R (APIENTRYP original)(Args...);
+			static unsigned long long count;
+
+			static R APIENTRY call(Args... args)
+			{
+				++count;
+				return original(args...);
+			}
+
+			static void install(const char *name)
+			{
+				if (original != nullptr || *Slot == nullptr) return;
+				original = *Slot;
+				*Slot = &call;
+				entries().push_back({ name, &count });
+			}
+		};
+	};
+
+	//deduce the signature of a glad function pointer
+	template <typename R, typename... Args>
+	static Signature<R, Args...> signatureOf(R (APIENTRYP)(Args...));
+};
+
+template <typename R, typename... Args>
+template <R (APIENTRYP *Slot)(Args...)>
+R (APIENTRYP GLCallCounter::Signature<R, Args...>::Hook<Slot>::original)(Args...) = nullptr;
+
+template <typename R, typename... Args>
+template <R (APIENTRYP *Slot)(Args...)>
+unsigned long long GLCallCounter::Signature<R, Args...>::Hook<Slot>::count = 0;
+
+#define GL_CALL_COUNTER_HOOK(f) decltype(signatureOf(glad_##f))::template Hook<&glad_##f>::install(#f)
+
+void GLCallCounter::install()
+{
+	//state
+	GL_CALL_COUNTER_HOOK(glUseProgram);
+	GL_CALL_COUNTER_HOOK(glBindVertexArray);
+	GL_CALL_COUNTER_HOOK(glBindBuffer);
+	GL_CALL_COUNTER_HOOK(glBindBufferBase);
+	GL_CALL_COUNTER_HOOK(glBindBufferRange);
+	GL_CALL_COUNTER_HOOK(glActiveTexture);
+	GL_CALL_COUNTER_HOOK(glBindTexture);
+	//uniforms
+	GL_CALL_COUNTER_HOOK(glGetUniformLocation);
+	GL_CALL_COUNTER_HOOK(glUniform1i);
+	GL_CALL_COUNTER_HOOK(glUniform1f);
+	GL_CALL_COUNTER_HOOK(glUniform3fv);
+	GL_CALL_COUNTER_HOOK(glUniform4fv);
+	GL_CALL_COUNTER_HOOK(glUniformMatrix4fv);
+	//buffers
+	GL_CALL_COUNTER_HOOK(glBufferData);
+	GL_CALL_COUNTER_HOOK(glBufferSubData);
+	//sync
+	GL_CALL_COUNTER_HOOK(glFenceSync);
+	GL_CALL_COUNTER_HOOK(glClientWaitSync);
+	GL_CALL_COUNTER_HOOK(glDeleteSync);
+	//draws
+	GL_CALL_COUNTER_HOOK(glClear);
+	GL_CALL_COUNTER_HOOK(glDrawArrays);
+	GL_CALL_COUNTER_HOOK(glDrawElements);
+	GL_CALL_COUNTER_HOOK(glDrawElementsInstancedBaseVertexBaseInstance);
+	GL_CALL_COUNTER_HOOK(glMultiDrawElementsIndirect);
+}
+
+#undef GL_CALL_COUNTER_HOOK
+
+std::vector<GLCallCounter::Entry>& GLCallCounter::entries()
+{
+	static std::vector<Entry> hooked;
+	return hooked;
+}
+
+unsigned long long GLCallCounter::total()
+{
+	unsigned long long n = 0;
+	for (const auto &e : entries())
+		n += *e.count;
+	return n;
+}
+
+void GLCallCounter::reset()
+{
+	for (const auto &e : entries())
+		*e.count = 0;
+}
+
+void GLCallCounter::print(std::ostream &os, unsigned long long frames)
+{
+	if (frames == 0) return;
+	os << "GL calls/frame: " << double(total()) / frames << std::endl;
+	for (const auto &e : entries())
+		if (*e.count > 0)
+			os << "  " << e.name << ": " << double(*e.count) / frames << std::endl;
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <glad\glad.h>
+#include <glm\glm.hpp>
+
+#include <VertexQuantizer.h>
+
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+//the draw range of a glyph in the store
+struct StoredGlyph
+{
+	GLuint firstIndex;
+	GLuint indexCount;
+	GLint baseVertex;
+};
+
+//the decode bounds of a glyph in the glyph buffer of text3D.vert(std430)
+struct StoredGlyphBounds
+{
+	glm::vec4 positionOffset;   //w is unused
+	glm::vec4 positionScale;
+};
+
+//the distinct glyph meshes of all text, every glyph is stored once in one shared vertex and index buffer,
+//all occurrences of a glyph in any text draw the same range
+//the buffers grow by doubling, a glyph added after the first upload is appended without uploading the others again
+class GlyphMeshStore
+{
+public:
+	GlyphMeshStore();
+
+	//the id of the glyph stored under key, -1 if there is none
+	int find(unsigned long long key) const;
+	//store a glyph under key, its indices are relative to its own first vertex, return its id
+	//a key stored before returns the id of the stored glyph
+	unsigned int add(unsigned long long key, const QuantizedVertex *v, size_t num_vertices, const GLuint *i, size_t num_indices,
+		const QuantizationBounds &bounds);
+
+	//the key of a glyph of a font face
+	static unsigned long long key(unsigned int font_id, unsigned int glyph_index)
+	{
+		return (static_cast<unsigned long long>(font_id) << 32) | glyph_index;
+	}
+
+	const StoredGlyph& glyph(unsigned int id) const { return _glyphs[id]; }
+	//the bounds of a glyph in its own space, its quantization bounds hold all its vertices and serve as its AABB,
+	//so glyphs from a pack and glyphs built at runtime get their boxes the same way
+	BoundingBox bounds(unsigned int id) const
+	{
+		return BoundingBox(glm::vec3(_bounds[id].positionOffset), glm::vec3(_bounds[id].positionOffset + _bounds[id].positionScale));
+	}
+	unsigned int getGlyphsNum() const { return _glyphs.size(); }
+
+	//upload the glyphs added since the last upload, the buffer names never change until release
+	void upload();
+	void release();
+
+	GLuint vertexBuffer() const { return _VBO; }
+	GLuint indexBuffer() const { return _EBO; }
+	GLuint boundsBuffer() const { return _boundsBuffer; }
+
+	//the bytes of the GPU buffers
+	size_t memorySize() const;
+	void printStats(std::ostream &os) const;
+
+private:
+	//upload [first, size) of data to buffer, the whole data is uploaded again if the buffer is too small
+	template <typename T>
+	static void uploadTail(GLenum target, GLuint buffer, const std::vector<T> &data, size_t first, size_t &capacity);
+
+	std::unordered_map<unsigned long long, unsigned int> _keys;
+	std::vector<StoredGlyph> _glyphs;
+	std::vector<StoredGlyphBounds> _bounds;
+	std::vector<QuantizedVertex> _vertices;
+	std::vector<GLuint> _indices;
+
+	GLuint _VBO, _EBO, _boundsBuffer;
+	size_t _uploadedGlyphs, _uploadedVertices, _uploadedIndices;
+	size_t _vertexCapacity, _indexCapacity, _boundsCapacity;
+};
+
+GlyphMeshStore::GlyphMeshStore() :
+_VBO(0), _EBO(0), _boundsBuffer(0),
+_uploadedGlyphs(0), _uploadedVertices(0), _uploadedIndices(0),
+_vertexCapacity(0), _indexCapacity(0), _boundsCapacity(0)
+{
+}
+
+int GlyphMeshStore::find(unsigned long long key) const
+{
+	auto itr = _keys.find(key);
+	return itr != _keys.end() ? int(itr->second) : -1;
+}
+
+unsigned int GlyphMeshStore::add(unsigned long long key, const QuantizedVertex *v, size_t num_vertices, const GLuint *i, size_t num_indices,
+	const QuantizationBounds &bounds)
+{
+	auto itr = _keys.find(key);
+	if (itr != _keys.end()) return itr->second;
+
+	StoredGlyph glyph;
+	glyph.firstIndex = _indices.size();
+	glyph.indexCount = num_indices;
+	glyph.baseVertex = _vertices.size();
+	_vertices.insert(_vertices.end(), v, v + num_vertices);
+	_indices.insert(_indices.end(), i, i + num_indices);
+
+	unsigned int id = _glyphs.size();
+	_glyphs.push_back(glyph);
+	_bounds.push_back({ glm::vec4(bounds.offset, 0.0f), glm::vec4(bounds.scale, 0.0f) });
+	_keys[key] = id;
+	return id;
+}
+
+template <typename T>
+void GlyphMeshStore::uploadTail(GLenum target, GLuint buffer, const std::vector<T> &data, size_t first, size_t &capacity)
+{
+	glBindBuffer(target, buffer);
+	if (data.size() > capacity)
+	{
+		capacity = std::max(data.size(), capacity * 2);
+		glBufferData(target, capacity * sizeof(T), nullptr, GL_STATIC_DRAW);
+		first = 0;
+	}
+	if (data.size() > first)
+		glBufferSubData(target, first * sizeof(T), (data.size() - first) * sizeof(T), data.data() + first);
+	glBindBuffer(target, 0);
+}
+
+void GlyphMeshStore::upload()
+{
+	//the names exist before the first glyph, so a VAO can be set up on an empty store
+	if (!_VBO)
+	{
+		glGenBuffers(1, &_VBO);
+		glGenBuffers(1, &_EBO);
+		glGenBuffers(1, &_boundsBuffer);
+	}
+	if (_uploadedGlyphs == _glyphs.size()) return;
+
+	//the index buffer is bound to GL_COPY_WRITE_BUFFER, so the element buffer of a bound VAO is left alone
+	uploadTail(GL_ARRAY_BUFFER, _VBO, _vertices, _uploadedVertices, _vertexCapacity);
+	uploadTail(GL_COPY_WRITE_BUFFER, _EBO, _indices, _uploadedIndices, _indexCapacity);
+	uploadTail(GL_SHADER_STORAGE_BUFFER, _boundsBuffer, _bounds, _uploadedGlyphs, _boundsCapacity);
+
+	_uploadedGlyphs = _glyphs.size();
+	_uploadedVertices = _vertices.size();
+	_uploadedIndices = _indices.size();
+}
+
+void GlyphMeshStore::release()
+{
+	if (!_VBO) return;
+	GLuint buffers[] = { _VBO, _EBO, _boundsBuffer };
+	glDeleteBuffers(3, buffers);
+	_VBO = _EBO = _boundsBuffer = 0;
+	_uploadedGlyphs = _uploadedVertices = _uploadedIndices = 0;
+	_vertexCapacity = _indexCapacity = _boundsCapacity = 0;
+}
+
+size_t GlyphMeshStore::memorySize() const
+{
+	return _vertexCapacity * sizeof(QuantizedVertex) + _indexCapacity * sizeof(GLuint) + _boundsCapacity * sizeof(StoredGlyphBounds);
+}
+
+void GlyphMeshStore::printStats(std::ostream &os) const
+{
+	os << "Glyph mesh store: " << _glyphs.size() << " glyphs, " << _vertices.size() << " vertices, "
+		<< _indices.size() << " indices, " << memorySize() / 1024 << " KB of GPU buffers" << std::endl;
+}
@@ -4,6 +4,9 @@
 #include <glm\glm.hpp>
 #include <glm\gtc\type_ptr.hpp>
 
+#include <cfloat>
+#include <cmath>
+
 //attenuation struct
 struct Attenuation
 {
@@ -19,6 +22,36 @@ struct Cutoff
 	GLfloat outerCutoff;
 };
 
+//the std140 layouts of the light structs of text3D.frag, a vec3 takes 16 bytes and a struct starts at a 16 bytes boundary
+struct DirLightBlock
+{
+	glm::vec4 direction;
+	glm::vec4 ambient;
+	glm::vec4 diffuse;
+	glm::vec4 specular;
+};
+
+//a point light or a spot light in the light buffer of text3D.frag(std430), every member is a vec4 so std430 and C++ agree
+struct LightBlock
+{
+	glm::vec4 position;     //w is the radius of the light
+	glm::vec4 direction;    //w is 1 for a spot light, 0 for a point light
+	glm::vec4 ambient;
+	glm::vec4 diffuse;
+	glm::vec4 specular;
+	glm::vec4 atten;        //constant, linear, quadratic
+	glm::vec4 cutoff;       //inner and outer cutoff
+};
+
+static_assert(sizeof(DirLightBlock) == 64, "DirLightBlock must match std140");
+static_assert(sizeof(LightBlock) == 112, "LightBlock must match std430");
+
+//a light is cut off where the attenuated sum of its colors falls below this, i.e. below one step of an 8 bits channel
+const GLfloat LightCutoff = 1.0f / 256.0f;
+
+//the distance where the attenuated light falls below LightCutoff
+GLfloat lightRadius(const glm::vec3 &ambient, const glm::vec3 &diffuse, const glm::vec3 &specular, const Attenuation &atten);
+
 class DirLight
 {
 public:
@@ -27,7 +60,7 @@ public:
 	glm::vec3 diffuse;
 	glm::vec3 specular;
 
-	void setUniform(GLuint id, GLuint offset);
+	DirLightBlock block() const;
 };
 
 class PointLight
@@ -42,7 +75,7 @@ public:
 	//the attenuation factor
 	Attenuation atten;
 
-	void setUniform(GLuint id, GLuint offset);
+	LightBlock block() const;
 };
 
 class SpotLight
@@ -59,44 +92,36 @@ public:
 	//cutoff angle
 	Cutoff cutoff;
 
-	void setUniform(GLuint id, GLuint offset);
+	LightBlock block() const;
 };
 
-void DirLight::setUniform(GLuint id, GLuint offset)
+DirLightBlock DirLight::block() const
 {
-	glBindBuffer(GL_UNIFORM_BUFFER, id);
-	glBufferSubData(GL_UNIFORM_BUFFER, offset +  0, 16, glm::value_ptr(direction));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 16, 16, glm::value_ptr(ambient));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 32, 16, glm::value_ptr(diffuse));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 48, 16, glm::value_ptr(specular));
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	return { glm::vec4(direction, 0.0f), glm::vec4(ambient, 0.0f), glm::vec4(diffuse, 0.0f), glm::vec4(specular, 0.0f) };
 }
 
-void PointLight::setUniform(GLuint id, GLuint offset)
+GLfloat lightRadius(const glm::vec3 &ambient, const glm::vec3 &diffuse, const glm::vec3 &specular, const Attenuation &atten)
 {
-	glBindBuffer(GL_UNIFORM_BUFFER, id);
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 0, 16, glm::value_ptr(position));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 16, 16, glm::value_ptr(ambient));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 32, 16, glm::value_ptr(diffuse));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 48, 16, glm::value_ptr(specular));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 64, 4, &atten.constant);
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 68, 4, &atten.linear);
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 72, 4, &atten.quadratic);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glm::vec3 sum = ambient + diffuse + specular;
+	//solve constant + linear * d + quadratic * d^2 = brightness / LightCutoff
+	GLfloat k = glm::max(sum.x, glm::max(sum.y, sum.z)) / LightCutoff - atten.constant;
+	if (k <= 0.0f) return 0.0f;
+	if (atten.quadratic > 0.0f)
+		return (-atten.linear + std::sqrt(atten.linear * atten.linear + 4.0f * atten.quadratic * k)) / (2.0f * atten.quadratic);
+	if (atten.linear > 0.0f)
+		return k / atten.linear;
+	return FLT_MAX;
 }
 
-void SpotLight::setUniform(GLuint id, GLuint offset)
+LightBlock PointLight::block() const
 {
-	glBindBuffer(GL_UNIFORM_BUFFER, id);
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 0, 16, glm::value_ptr(position));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 16, 16, glm::value_ptr(direction));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 32, 16, glm::value_ptr(ambient));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 48, 16, glm::value_ptr(diffuse));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 64, 16, glm::value_ptr(specular));
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 80, 4, &atten.constant);
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 84, 4, &atten.linear);
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 88, 4, &atten.quadratic);
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 96, 4, &cutoff.innerCutoff);
-	glBufferSubData(GL_UNIFORM_BUFFER, offset + 100, 4, &cutoff.outerCutoff);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
-}
\ No newline at end of file
+	return { glm::vec4(position, lightRadius(ambient, diffuse, specular, atten)), glm::vec4(0.0f), glm::vec4(ambient, 0.0f),
+		glm::vec4(diffuse, 0.0f), glm::vec4(specular, 0.0f), glm::vec4(atten.constant, atten.linear, atten.quadratic, 0.0f), glm::vec4(0.0f) };
+}
+
+LightBlock SpotLight::block() const
+{
+	return { glm::vec4(position, lightRadius(ambient, diffuse, specular, atten)), glm::vec4(direction, 1.0f), glm::vec4(ambient, 0.0f),
+		glm::vec4(diffuse, 0.0f), glm::vec4(specular, 0.0f), glm::vec4(atten.constant, atten.linear, atten.quadratic, 0.0f),
+		glm::vec4(cutoff.innerCutoff, cutoff.outerCutoff, 0.0f, 0.0f) };
+}
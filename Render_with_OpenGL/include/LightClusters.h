@@ -0,0 +1,263 @@
+#pragma once
+
+#include <glad\glad.h>
+#include <glm\glm.hpp>
+
+#include <Light.h>
+#include <FrameConstants.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+
+//clustered forward lighting: the view frustum is split to tiles on the screen and to slices of exponential depth,
+//every frame the point lights and spot lights are binned into the clusters their spheres touch,
+//so a fragment of text3D.frag evaluates only the lights of its own cluster
+//the lights, the light range of every cluster and the light indices are shader storage buffers(bindings 4, 5 and 6)
+class LightClusters
+{
+public:
+	static const GLuint LightBinding = 4;
+	static const GLuint ClusterBinding = 5;
+	static const GLuint IndexBinding = 6;
+
+	//the point lights and spot lights in world space
+	std::vector<LightBlock> lights;
+
+	LightClusters(GLuint tiles_x = 16, GLuint tiles_y = 9, GLuint slices = 24);
+
+	//bin the lights for a frame, near_plane and far_plane must be the planes of projection, width and height are the viewport
+	void build(const glm::mat4 &view, const glm::mat4 &projection, float near_plane, float far_plane, GLuint width, GLuint height);
+	//write the grid of the last build to the Lights block
+	void setBlock(LightsBlock &block) const;
+	//upload the lights and the clusters of the last build and bind them
+	void upload();
+	void release();
+
+	GLuint getClustersNum() const { return _tilesX * _tilesY * _slices; }
+	//the light indices of the last build, i.e. the lights summed over the clusters
+	size_t getIndicesNum() const { return _indices.size(); }
+	//the spot lights binned by the last build, without any the point light variant of text3D.frag is enough
+	GLuint getSpotLightsNum() const { return _spotLights; }
+	void printStats(std::ostream &os) const;
+
+private:
+	//the view space bounds of every cluster, they change only with the projection
+	void computeBounds(const glm::mat4 &projection, float near_plane, float far_plane);
+	GLuint slice(float depth) const;
+	//upload data to buffer, which grows by doubling
+	template <typename T>
+	static void uploadBuffer(GLuint buffer, const std::vector<T> &data, size_t &capacity);
+
+	GLuint _tilesX, _tilesY, _slices;
+	glm::vec2 _tilesPerPixel;
+	float _sliceScale, _sliceBias;
+
+	glm::mat4 _boundsProjection;
+	float _boundsNear, _boundsFar;
+	std::vector<glm::vec3> _boundsMin, _boundsMax;
+
+	std::vector<glm::uvec2> _clusters;      //the offset and count of the light indices of every cluster
+	std::vector<GLuint> _indices;
+	std::vector<glm::uvec2> _pairs;         //(cluster, light) of every light touching a cluster
+	GLuint _spotLights;
+
+	GLuint _buffers[3];
+	size_t _capacity[3];
+
+	//the stats of all builds
+	unsigned long long _builds;
+	double _buildTime;                      //seconds
+	unsigned long long _pairsSum;
+	GLuint _maxClusterLights;
+};
+
+LightClusters::LightClusters(GLuint tiles_x, GLuint tiles_y, GLuint slices) :
+_tilesX(tiles_x), _tilesY(tiles_y), _slices(slices),
+_tilesPerPixel(0.0f), _sliceScale(0.0f), _sliceBias(0.0f),
+_boundsProjection(0.0f), _boundsNear(0.0f), _boundsFar(0.0f),
+_spotLights(0),
+_builds(0), _buildTime(0.0), _pairsSum(0), _maxClusterLights(0)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		_buffers[i] = 0;
+		_capacity[i] = 0;
+	}
+}
+
+GLuint LightClusters::slice(float depth) const
+{
+	float k = std::log(depth) * _sliceScale + _sliceBias;
+	return GLuint(glm::clamp(k, 0.0f, float(_slices - 1)));
+}
+
+void LightClusters::computeBounds(const glm::mat4 &projection, float near_plane, float far_plane)
+{
+	_boundsProjection = projection;
+	_boundsNear = near_plane;
+	_boundsFar = far_plane;
+	_boundsMin.resize(getClustersNum());
+	_boundsMax.resize(getClustersNum());
+
+	//the view space ray through every corner of the tiles, scaled to depth 1
+	glm::mat4 invProjection = glm::inverse(projection);
+	std::vector<glm::vec3> rays((_tilesX + 1) * (_tilesY + 1));
+	for (GLuint y = 0; y <= _tilesY; ++y)
+		for (GLuint x = 0; x <= _tilesX; ++x)
+		{
+			glm::vec4 p = invProjection * glm::vec4(-1.0f + 2.0f * x / _tilesX, -1.0f + 2.0f * y / _tilesY, -1.0f, 1.0f);
+			rays[y * (_tilesX + 1) + x] = glm::vec3(p) / -p.z;
+		}
+
+	for (GLuint z = 0; z < _slices; ++z)
+	{
+		float depths[2] = { near_plane * std::pow(far_plane / near_plane, float(z) / _slices),
+			near_plane * std::pow(far_plane / near_plane, float(z + 1) / _slices) };
+		for (GLuint y = 0; y < _tilesY; ++y)
+			for (GLuint x = 0; x < _tilesX; ++x)
+			{
+				glm::vec3 bmin(FLT_MAX), bmax(-FLT_MAX);
+				for (GLuint corner = 0; corner < 4; ++corner)
+				{
+					const glm::vec3 &ray = rays[(y + corner / 2) * (_tilesX + 1) + x + corner % 2];
+					for (float d : depths)
+					{
+						bmin = glm::min(bmin, ray * d);
+						bmax = glm::max(bmax, ray * d);
+					}
+				}
+				GLuint c = x + _tilesX * (y + _tilesY * z);
+				_boundsMin[c] = bmin;
+				_boundsMax[c] = bmax;
+			}
+	}
+}
+
+void LightClusters::build(const glm::mat4 &view, const glm::mat4 &projection, float near_plane, float far_plane, GLuint width, GLuint height)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	if (projection != _boundsProjection || near_plane != _boundsNear || far_plane != _boundsFar)
+		computeBounds(projection, near_plane, far_plane);
+	_tilesPerPixel = glm::vec2(float(_tilesX) / width, float(_tilesY) / height);
+	_sliceScale = float(_slices) / std::log(far_plane / near_plane);
+	_sliceBias = -_sliceScale * std::log(near_plane);
+
+	_pairs.clear();
+	_spotLights = 0;
+	for (GLuint i = 0; i < lights.size(); ++i)
+	{
+		glm::vec3 c = glm::vec3(view * glm::vec4(glm::vec3(lights[i].position), 1.0f));
+		float r = lights[i].position.w;
+		float depthMin = -c.z - r, depthMax = -c.z + r;
+		if (depthMax <= near_plane || depthMin >= far_plane) continue;
+
+		//the tiles covered by the projected bounding box of the sphere, all tiles if the sphere crosses the near plane
+		glm::ivec2 tileMin(0), tileMax(_tilesX - 1, _tilesY - 1);
+		if (depthMin > near_plane)
+		{
+			glm::vec2 ndcMin(FLT_MAX), ndcMax(-FLT_MAX);
+			for (int corner = 0; corner < 8; ++corner)
+			{
+				glm::vec3 p = c + glm::vec3(corner & 1 ? r : -r, corner & 2 ? r : -r, corner & 4 ? r : -r);
+				glm::vec4 clip = projection * glm::vec4(p, 1.0f);
+				ndcMin = glm::min(ndcMin, glm::vec2(clip) / clip.w);
+				ndcMax = glm::max(ndcMax, glm::vec2(clip) / clip.w);
+			}
+			if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f) continue;
+			glm::vec2 tiles(_tilesX, _tilesY);
+			tileMin = glm::max(glm::ivec2(glm::floor((ndcMin * 0.5f + 0.5f) * tiles)), tileMin);
+			tileMax = glm::min(glm::ivec2(glm::floor((ndcMax * 0.5f + 0.5f) * tiles)), tileMax);
+		}
+
+		size_t pairs = _pairs.size();
+		GLuint sliceMin = slice(std::max(depthMin, near_plane)), sliceMax = slice(std::min(depthMax, far_plane));
+		for (GLuint z = sliceMin; z <= sliceMax; ++z)
+			for (int y = tileMin.y; y <= tileMax.y; ++y)
+				for (int x = tileMin.x; x <= tileMax.x; ++x)
+				{
+					//the sphere must touch the bounds of the cluster
+					GLuint cluster = x + _tilesX * (y + _tilesY * z);
+					glm::vec3 d = glm::max(glm::max(_boundsMin[cluster] - c, c - _boundsMax[cluster]), glm::vec3(0.0f));
+					if (glm::dot(d, d) <= r * r)
+						_pairs.push_back(glm::uvec2(cluster, i));
+				}
+		if (_pairs.size() > pairs && lights[i].direction.w > 0.5f)
+			++_spotLights;
+	}
+
+	//counting sort of the pairs by cluster, the lights of a cluster keep their order
+	_clusters.assign(getClustersNum(), glm::uvec2(0));
+	for (const auto &p : _pairs)
+		++_clusters[p.x].y;
+	GLuint offset = 0;
+	for (auto &c : _clusters)
+	{
+		c.x = offset;
+		offset += c.y;
+		_maxClusterLights = std::max(_maxClusterLights, c.y);
+	}
+	_indices.resize(_pairs.size());
+	for (const auto &p : _pairs)
+		_indices[_clusters[p.x].x++] = p.y;
+	for (auto &c : _clusters)
+		c.x -= c.y;
+
+	++_builds;
+	_pairsSum += _pairs.size();
+	_buildTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void LightClusters::setBlock(LightsBlock &block) const
+{
+	block.clusterGrid = glm::uvec4(_tilesX, _tilesY, _slices, lights.size());
+	block.clusterParams = glm::vec4(_tilesPerPixel, _sliceScale, _sliceBias);
+}
+
+template <typename T>
+void LightClusters::uploadBuffer(GLuint buffer, const std::vector<T> &data, size_t &capacity)
+{
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+	if (data.size() > capacity || capacity == 0)
+	{
+		capacity = std::max<size_t>(std::max(data.size(), capacity * 2), 1);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+	}
+	if (!data.empty())
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, data.size() * sizeof(T), data.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void LightClusters::upload()
+{
+	if (!_buffers[0])
+		glGenBuffers(3, _buffers);
+	uploadBuffer(_buffers[0], lights, _capacity[0]);
+	uploadBuffer(_buffers[1], _clusters, _capacity[1]);
+	uploadBuffer(_buffers[2], _indices, _capacity[2]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LightBinding, _buffers[0]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ClusterBinding, _buffers[1]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, IndexBinding, _buffers[2]);
+}
+
+void LightClusters::release()
+{
+	if (!_buffers[0]) return;
+	glDeleteBuffers(3, _buffers);
+	for (int i = 0; i < 3; ++i)
+	{
+		_buffers[i] = 0;
+		_capacity[i] = 0;
+	}
+}
+
+void LightClusters::printStats(std::ostream &os) const
+{
+	if (_builds == 0) return;
+	os << "Light clusters: " << lights.size() << " lights in " << _tilesX << "x" << _tilesY << "x" << _slices << " clusters, "
+		<< double(_pairsSum) / _builds / getClustersNum() << " lights/cluster(max " << _maxClusterLights << "), build "
+		<< _buildTime * 1000.0 / _builds << " ms" << std::endl;
+}
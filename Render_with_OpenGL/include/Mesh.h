@@ -30,10 +30,16 @@ public:
 	GLuint VAO, VBO, EBO;
 
 	explicit Mesh(const std::vector<Vertex> &v, const std::vector<GLuint> &i = {}, const std::vector<Texture2D> &t = {});
-	void draw(Shader shader) const;
+	void draw(const Shader &shader) const;
 
 private:
+	//resolve the sampler handles of the textures for a program
+	void resolveSamplers(const Shader &shader) const;
 	void setupVAO();
+
+	//the sampler of every texture in the program that drew the mesh last time
+	mutable GLuint _samplerProgram = 0;
+	mutable std::vector<UniformHandle<GLint>> _samplers;
 };
 
 Mesh::Mesh(const std::vector<Vertex> &v, const std::vector<GLuint> &i, const std::vector<Texture2D> &t) :
@@ -42,23 +48,14 @@ vertices(v), indices(i), textures(t)
 	setupVAO();
 }
 
-void Mesh::draw(Shader shader) const
+void Mesh::draw(const Shader &shader) const
 {
-	unsigned diffNum = 1, specNum = 1;
+	if (_samplerProgram != shader.program)
+		resolveSamplers(shader);
 	for (size_t i = 0; i < textures.size(); ++i)
 	{
 		glActiveTexture(GL_TEXTURE0 + i);
-		int n = 0;
-		std::string t = textures[i].type;
-		//we use n to judge the texture's name in shader
-		//in shader we must named textures as "texture_diffuseN" or "texture_specularN" or others(N is start from 1)
-		if (t == "texture_diffuse")
-			n = diffNum++;
-		else if (t == "texture_specular")
-			n = specNum++;
-		std::string N = std::to_string(n);
-		//don't forget "material.", in shader the sampler of texture is in Material structure
-		shader.setUniformInt("material." + t + N, i);
+		shader.set(_samplers[i], i);
 		glBindTexture(GL_TEXTURE_2D, textures[i].id);
 	}
 
@@ -72,6 +69,26 @@ void Mesh::draw(Shader shader) const
 	glActiveTexture(GL_TEXTURE0);
 }
 
+void Mesh::resolveSamplers(const Shader &shader) const
+{
+	unsigned diffNum = 1, specNum = 1;
+	_samplers.clear();
+	for (size_t i = 0; i < textures.size(); ++i)
+	{
+		int n = 0;
+		const std::string &t = textures[i].type;
+		//we use n to judge the texture's name in shader
+		//in shader we must named textures as "texture_diffuseN" or "texture_specularN" or others(N is start from 1)
+		if (t == "texture_diffuse")
+			n = diffNum++;
+		else if (t == "texture_specular")
+			n = specNum++;
+		//don't forget "material.", in shader the sampler of texture is in Material structure
+		_samplers.push_back(shader.uniform<GLint>("material." + t + std::to_string(n)));
+	}
+	_samplerProgram = shader.program;
+}
+
 void Mesh::setupVAO()
 {
 	if (vertices.empty())
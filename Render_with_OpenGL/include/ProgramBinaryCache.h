@@ -0,0 +1,189 @@
+//a disk cache of linked programs, so a program is compiled from source only once per driver
+//every program is a file <prefix><key>.glbin of a ProgramBinaryHeader and the binary of glGetProgramBinary,
+//the key is a hash of the sources with their defines and the strings of the driver,
+//a binary rejected by glProgramBinary(e.g. after an update of the driver) is compiled from source and saved again
+#pragma once
+
+#include <glad\glad.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const char ProgramBinaryMagic[4] = { 'T', '3', 'P', 'B' };
+const unsigned int ProgramBinaryVersion = 1;
+
+struct ProgramBinaryHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned long long key;          //the key the file is named by, a renamed file is rejected
+	unsigned int format;             //the binary format of glGetProgramBinary
+	unsigned int length;             //the bytes of the binary after the header
+	unsigned int reserved[2];
+};
+
+static_assert(sizeof(ProgramBinaryHeader) == 32, "ProgramBinaryHeader must be 32 bytes");
+
+class ProgramBinaryCache
+{
+public:
+	//prefix is the directory and the beginning of the file names, e.g. "shader/", the directory must exist
+	explicit ProgramBinaryCache(const std::string &prefix);
+
+	//false if the context supports no program binary format, then load always fails and save does nothing
+	bool isSupported() const;
+
+	//the key of the program of a vertex shader and a fragment shader, the sources include their defines
+	unsigned long long key(const std::string &vertCode, const std::string &fragCode);
+	//a program linked from the cached binary of key, 0 if there is none or the driver rejects it
+	GLuint load(unsigned long long key);
+	//save the binary of a linked program, it must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+	bool save(GLuint program, unsigned long long key);
+
+	void printStats(std::ostream &os) const;
+
+private:
+	std::string path(unsigned long long key) const;
+	//64 bits FNV-1a
+	static unsigned long long hash(const void *data, size_t size, unsigned long long h);
+
+	std::string _prefix;
+	unsigned long long _driverHash;    //0 until the first key
+	unsigned int _loaded, _missing, _rejected, _saved;
+	double _loadTime;                  //seconds
+};
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string &prefix) :
+_prefix(prefix),
+_driverHash(0),
+_loaded(0), _missing(0), _rejected(0), _saved(0),
+_loadTime(0.0)
+{
+}
+
+bool ProgramBinaryCache::isSupported() const
+{
+	if (!GLAD_GL_VERSION_4_1) return false;
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return formats > 0;
+}
+
+unsigned long long ProgramBinaryCache::hash(const void *data, size_t size, unsigned long long h)
+{
+	const unsigned char *p = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		h ^= p[i];
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+unsigned long long ProgramBinaryCache::key(const std::string &vertCode, const std::string &fragCode)
+{
+	//a binary is only valid for the driver it was made by
+	if (_driverHash == 0)
+	{
+		_driverHash = 14695981039346656037ull;
+		const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+		for (GLenum s : strings)
+		{
+			const char *str = reinterpret_cast<const char*>(glGetString(s));
+			if (str)
+				_driverHash = hash(str, std::strlen(str) + 1, _driverHash);
+		}
+	}
+	unsigned long long h = hash(vertCode.c_str(), vertCode.size() + 1, _driverHash);
+	return hash(fragCode.c_str(), fragCode.size() + 1, h);
+}
+
+std::string ProgramBinaryCache::path(unsigned long long key) const
+{
+	char name[17];
+	std::snprintf(name, sizeof(name), "%016llx", key);
+	return _prefix + name + ".glbin";
+}
+
+GLuint ProgramBinaryCache::load(unsigned long long key)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	if (!isSupported()) return 0;
+
+	std::ifstream fin(path(key), std::ios::binary);
+	ProgramBinaryHeader header;
+	if (!fin || !fin.read(reinterpret_cast<char*>(&header), sizeof(header)))
+	{
+		++_missing;
+		return 0;
+	}
+	std::vector<char> binary;
+	if (std::memcmp(header.magic, ProgramBinaryMagic, 4) == 0 && header.version == ProgramBinaryVersion && header.key == key)
+	{
+		binary.resize(header.length);
+		if (!fin.read(binary.data(), binary.size()))
+			binary.clear();
+	}
+	if (binary.empty())
+	{
+		std::cout << "ProgramBinaryCache: " << path(key) << " is not a valid program binary of version " << ProgramBinaryVersion << std::endl;
+		++_rejected;
+		return 0;
+	}
+
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, header.format, binary.data(), binary.size());
+	GLint success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		std::cout << "ProgramBinaryCache: the driver rejected " << path(key) << ", it is compiled from source" << std::endl;
+		glDeleteProgram(program);
+		++_rejected;
+		return 0;
+	}
+	++_loaded;
+	_loadTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	return program;
+}
+
+bool ProgramBinaryCache::save(GLuint program, unsigned long long key)
+{
+	if (!isSupported()) return false;
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return false;
+	ProgramBinaryHeader header = {};
+	std::memcpy(header.magic, ProgramBinaryMagic, 4);
+	header.version = ProgramBinaryVersion;
+	header.key = key;
+	std::vector<char> binary(length);
+	GLsizei written = 0;
+	glGetProgramBinary(program, length, &written, &header.format, binary.data());
+	if (written <= 0) return false;
+	header.length = written;
+
+	std::ofstream fout(path(key), std::ios::binary);
+	if (!fout)
+	{
+		std::cout << "ProgramBinaryCache: Failed to create " << path(key) << std::endl;
+		return false;
+	}
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fout.write(binary.data(), written);
+	if (!fout) return false;
+	++_saved;
+	return true;
+}
+
+void ProgramBinaryCache::printStats(std::ostream &os) const
+{
+	os << "Program binary cache: " << _loaded << " loaded(" << (_loaded ? _loadTime * 1000.0 / _loaded : 0.0) << " ms each), "
+		<< _missing << " missing, " << _rejected << " rejected, " << _saved << " saved" << std::endl;
+}
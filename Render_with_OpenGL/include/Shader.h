@@ -5,29 +5,109 @@
 #include <glm\glm.hpp>
 #include <glm\gtc\type_ptr.hpp>
 
+#include <ProgramBinaryCache.h>
+
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <map>
+#include <algorithm>
+
+//an active uniform of a linked program
+struct UniformInfo
+{
+	GLint location;
+	GLenum type;        //e.g. GL_FLOAT_VEC3, GL_SAMPLER_2D
+	GLint size;         //the number of elements of an array, 1 otherwise
+};
+
+//an active uniform block or shader storage block of a linked program
+struct UniformBlockInfo
+{
+	GLenum interface;   //GL_UNIFORM_BLOCK or GL_SHADER_STORAGE_BLOCK
+	GLuint index;
+	GLint binding;
+	GLint dataSize;     //the minimum bytes of the buffer, the size of a runtime sized array counts as 1
+};
+
+//a precomputed uniform location, setting it through Shader::set costs no string operation and no location query
+//T is the C++ type of the value, a handle of a missing uniform has location -1 and is ignored by GL
+template <typename T>
+struct UniformHandle
+{
+	GLint location = -1;
 
+	bool valid() const { return location >= 0; }
+};
+
+//the GL types accepted by a handle of T, the samplers and bools are set as ints
+template <typename T> struct UniformTypes;
+template <> struct UniformTypes<GLint> { static bool accepts(GLenum t) { return t == GL_INT || t == GL_BOOL || (t >= GL_SAMPLER_1D && t <= GL_SAMPLER_2D_SHADOW); } };
+template <> struct UniformTypes<GLfloat> { static bool accepts(GLenum t) { return t == GL_FLOAT; } };
+template <> struct UniformTypes<glm::vec3> { static bool accepts(GLenum t) { return t == GL_FLOAT_VEC3; } };
+template <> struct UniformTypes<glm::vec4> { static bool accepts(GLenum t) { return t == GL_FLOAT_VEC4; } };
+template <> struct UniformTypes<glm::mat4> { static bool accepts(GLenum t) { return t == GL_FLOAT_MAT4; } };
+
+//the macros of a shader variant, name -> value, an empty value defines the name only
+//the map is sorted, so equal sets of defines always give the same text
+typedef std::map<std::string, std::string> ShaderDefines;
+
+//a program of a vertex shader and a fragment shader
+//the defines are injected right after the #version line of both shaders, so a variant is specialized when it is compiled
+//with a ProgramBinaryCache the program is loaded from its cached binary, the shaders are compiled only if there is none
+//all active uniforms and blocks are reflected into hash tables once the program is linked,
+//so the name of a uniform is looked up in memory and never queried from GL again
 class Shader
 {
 public:
 	GLuint program;
 
-	Shader(const std::string &vPath, const std::string &fPath);
+	Shader(const std::string &vPath, const std::string &fPath, const ShaderDefines &defines = ShaderDefines(),
+		ProgramBinaryCache *binaries = nullptr);
 	void use() const;
+
+	const ShaderDefines& getDefines() const { return _defines; }
+	//the defines as #define lines
+	static std::string defineLines(const ShaderDefines &defines);
+
+	//the handle of a uniform, resolve it once and keep it, an error is printed if the uniform has another type
+	template <typename T>
+	UniformHandle<T> uniform(const std::string &name) const;
+	//set a uniform of the program in use
+	void set(UniformHandle<GLint> h, GLint value) const { glUniform1i(h.location, value); }
+	void set(UniformHandle<GLfloat> h, GLfloat value) const { glUniform1f(h.location, value); }
+	void set(UniformHandle<glm::vec3> h, const glm::vec3 &v) const { glUniform3fv(h.location, 1, glm::value_ptr(v)); }
+	void set(UniformHandle<glm::vec4> h, const glm::vec4 &v) const { glUniform4fv(h.location, 1, glm::value_ptr(v)); }
+	void set(UniformHandle<glm::mat4> h, const glm::mat4 &m) const { glUniformMatrix4fv(h.location, 1, GL_FALSE, glm::value_ptr(m)); }
+
+	//set a uniform by name, the location is looked up in the reflected table
 	void setUniformBool(const std::string &name, GLboolean value) const;
 	void setUniformInt(const std::string &name, GLint value) const;
 	void setUniformFloat(const std::string &name, GLfloat value) const;
-	void setUniformVec3(const std::string &name, const glm::vec3 &v);
-	void setUniformMat4(const std::string &name, const glm::mat4 &m);
+	void setUniformVec3(const std::string &name, const glm::vec3 &v) const;
+	void setUniformMat4(const std::string &name, const glm::mat4 &m) const;
+
+	//return nullptr if the program has no such active uniform or block
+	const UniformInfo* findUniform(const std::string &name) const;
+	const UniformBlockInfo* findBlock(const std::string &name) const;
+	void printReflection(std::ostream &os) const;
 
 private:
 	void checkErro(GLuint shader, const std::string &type) const;
+	//insert the defines after the #version line, #line keeps the line numbers of the compile errors
+	static std::string injectDefines(const std::string &code, const ShaderDefines &defines);
+	void reflect();
+	GLint location(const std::string &name) const;
+
+	std::unordered_map<std::string, UniformInfo> _uniforms;
+	std::unordered_map<std::string, UniformBlockInfo> _blocks;
+	ShaderDefines _defines;
 };
 
-Shader::Shader(const std::string &vPath, const std::string &fPath)
+Shader::Shader(const std::string &vPath, const std::string &fPath, const ShaderDefines &defines, ProgramBinaryCache *binaries) :
+_defines(defines)
 {
 	//read the code from shader file
 	std::ifstream vertFile, fragFile;
@@ -43,14 +123,27 @@ Shader::Shader(const std::string &vPath, const std::string &fPath)
 		fStream << fragFile.rdbuf();
 		vertFile.close();
 		fragFile.close();
-		vertCode = vStream.str();
-		fragCode = fStream.str();
+		vertCode = injectDefines(vStream.str(), defines);
+		fragCode = injectDefines(fStream.str(), defines);
 	}
 	catch (std::ifstream::failure e)
 	{
 		std::cerr << "ERRO::SHADER::FILE_NOT_SUCCESSFULLY_READ";
 		std::abort();
 	}
+
+	unsigned long long binaryKey = 0;
+	if (binaries)
+	{
+		binaryKey = binaries->key(vertCode, fragCode);
+		program = binaries->load(binaryKey);
+		if (program)
+		{
+			reflect();
+			return;
+		}
+	}
+
 	const char *vc = vertCode.c_str();
 	const char *fc = fragCode.c_str();
 	GLint success = 0;
@@ -71,11 +164,17 @@ Shader::Shader(const std::string &vPath, const std::string &fPath)
 	program = glCreateProgram();
 	glAttachShader(program, vshader);
 	glAttachShader(program, fshader);
+	if (binaries)
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(program);
 	checkErro(program, "PROGRAM");
+	if (binaries)
+		binaries->save(program, binaryKey);
 
 	glDeleteShader(vshader);
 	glDeleteShader(fshader);
+
+	reflect();
 }
 
 void Shader::use() const
@@ -83,28 +182,163 @@ void Shader::use() const
 	glUseProgram(program);
 }
 
+std::string Shader::defineLines(const ShaderDefines &defines)
+{
+	std::string lines;
+	for (const auto &d : defines)
+	{
+		lines += "#define " + d.first;
+		if (!d.second.empty())
+			lines += " " + d.second;
+		lines += "\n";
+	}
+	return lines;
+}
+
+std::string Shader::injectDefines(const std::string &code, const ShaderDefines &defines)
+{
+	if (defines.empty()) return code;
+	//#version must stay the first line, a shader without it gets the defines at the top
+	size_t versionLine = 0, line = 1;
+	size_t version = code.find("#version");
+	if (version != std::string::npos)
+	{
+		versionLine = code.find('\n', version);
+		if (versionLine == std::string::npos)
+			return code + "\n" + defineLines(defines);
+		++versionLine;
+		line = std::count(code.begin(), code.begin() + versionLine, '\n') + 1;
+	}
+	return code.substr(0, versionLine) + defineLines(defines) + "#line " + std::to_string(line) + "\n" + code.substr(versionLine);
+}
+
+template <typename T>
+UniformHandle<T> Shader::uniform(const std::string &name) const
+{
+	UniformHandle<T> h;
+	const UniformInfo *info = findUniform(name);
+	if (info == nullptr) return h;
+	if (!UniformTypes<T>::accepts(info->type))
+	{
+		std::cerr << "ERRO::SHADER::UNIFORM_TYPE_MISMATCH " << name << std::endl;
+		return h;
+	}
+	h.location = info->location;
+	return h;
+}
+
 void Shader::setUniformBool(const std::string &name, GLboolean value) const
 {
-	glUniform1i(glGetUniformLocation(program, name.c_str()), value);
+	glUniform1i(location(name), value);
 }
 void Shader::setUniformInt(const std::string &name, GLint value) const
 {
-	glUniform1i(glGetUniformLocation(program, name.c_str()), value);
+	glUniform1i(location(name), value);
 }
 
 void Shader::setUniformFloat(const std::string &name, GLfloat value) const
 {
-	glUniform1f(glGetUniformLocation(program, name.c_str()), value);
+	glUniform1f(location(name), value);
 }
 
-void Shader::setUniformVec3(const std::string &name, const glm::vec3 &v)
+void Shader::setUniformVec3(const std::string &name, const glm::vec3 &v) const
 {
-	glUniform3fv(glGetUniformLocation(program, name.c_str()), 1, glm::value_ptr(v));
+	glUniform3fv(location(name), 1, glm::value_ptr(v));
+}
+
+void Shader::setUniformMat4(const std::string &name, const glm::mat4 &m) const
+{
+	glUniformMatrix4fv(location(name), 1, GL_FALSE, glm::value_ptr(m));
+}
+
+const UniformInfo* Shader::findUniform(const std::string &name) const
+{
+	auto itr = _uniforms.find(name);
+	return itr != _uniforms.end() ? &itr->second : nullptr;
+}
+
+const UniformBlockInfo* Shader::findBlock(const std::string &name) const
+{
+	auto itr = _blocks.find(name);
+	return itr != _blocks.end() ? &itr->second : nullptr;
+}
+
+GLint Shader::location(const std::string &name) const
+{
+	const UniformInfo *info = findUniform(name);
+	return info ? info->location : -1;
+}
+
+void Shader::reflect()
+{
+	GLint count = 0, maxLength = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	std::string name(std::max(maxLength, 1), '\0');
+	for (GLint i = 0; i < count; ++i)
+	{
+		GLsizei length = 0;
+		UniformInfo info;
+		glGetActiveUniform(program, i, maxLength, &length, &info.size, &info.type, &name[0]);
+		std::string n(name.data(), length);
+		info.location = glGetUniformLocation(program, n.c_str());
+		//the members of the blocks have no location
+		if (info.location < 0) continue;
+
+		//an array is reported as "a[0]", it is registered as "a" and as every "a[i]"
+		if (n.size() > 3 && n.compare(n.size() - 3, 3, "[0]") == 0)
+		{
+			std::string base = n.substr(0, n.size() - 3);
+			_uniforms[base] = info;
+			for (GLint e = 0; e < info.size; ++e)
+			{
+				std::string element = base + "[" + std::to_string(e) + "]";
+				UniformInfo elementInfo = { glGetUniformLocation(program, element.c_str()), info.type, 1 };
+				_uniforms[element] = elementInfo;
+			}
+		}
+		else
+			_uniforms[n] = info;
+	}
+
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+	name.assign(std::max(maxLength, 1), '\0');
+	for (GLint i = 0; i < count; ++i)
+	{
+		GLsizei length = 0;
+		UniformBlockInfo info = { GL_UNIFORM_BLOCK, GLuint(i), 0, 0 };
+		glGetActiveUniformBlockName(program, i, maxLength, &length, &name[0]);
+		glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_BINDING, &info.binding);
+		glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &info.dataSize);
+		_blocks[std::string(name.data(), length)] = info;
+	}
+
+	//the shader storage blocks are only reported by the program interface query(opengl 4.3)
+	if (!GLAD_GL_VERSION_4_3) return;
+	glGetProgramInterfaceiv(program, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &count);
+	glGetProgramInterfaceiv(program, GL_SHADER_STORAGE_BLOCK, GL_MAX_NAME_LENGTH, &maxLength);
+	name.assign(std::max(maxLength, 1), '\0');
+	for (GLint i = 0; i < count; ++i)
+	{
+		GLsizei length = 0;
+		const GLenum props[] = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+		GLint values[2] = {};
+		glGetProgramResourceName(program, GL_SHADER_STORAGE_BLOCK, i, maxLength, &length, &name[0]);
+		glGetProgramResourceiv(program, GL_SHADER_STORAGE_BLOCK, i, 2, props, 2, nullptr, values);
+		_blocks[std::string(name.data(), length)] = { GL_SHADER_STORAGE_BLOCK, GLuint(i), values[0], values[1] };
+	}
 }
 
-void Shader::setUniformMat4(const std::string &name, const glm::mat4 &m)
+void Shader::printReflection(std::ostream &os) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, glm::value_ptr(m));
+	os << "Program " << program << ": " << _uniforms.size() << " uniforms, " << _blocks.size() << " blocks" << std::endl;
+	for (const auto &u : _uniforms)
+		os << "  uniform " << u.first << ": location " << u.second.location << ", type 0x" << std::hex << u.second.type << std::dec
+			<< ", size " << u.second.size << std::endl;
+	for (const auto &b : _blocks)
+		os << "  " << (b.second.interface == GL_UNIFORM_BLOCK ? "uniform" : "buffer") << " block " << b.first
+			<< ": binding " << b.second.binding << ", " << b.second.dataSize << " bytes" << std::endl;
 }
 
 void Shader::checkErro(GLuint shader, const std::string &type) const
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glad\glad.h>
+
+#include <Shader.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+//the compiled variants of the shaders, a variant is a vert/frag pair with a set of defines
+//every variant is compiled and linked once, asking for it again returns the cached program
+//with a ProgramBinaryCache the variants are loaded from the binaries of earlier runs
+class ShaderCache
+{
+public:
+	explicit ShaderCache(ProgramBinaryCache *binaries = nullptr);
+
+	//the variant of the shaders, compiled at the first request, the reference is valid until release
+	Shader& get(const std::string &vPath, const std::string &fPath, const ShaderDefines &defines = ShaderDefines());
+	//return nullptr if the variant isn't compiled yet
+	Shader* find(const std::string &vPath, const std::string &fPath, const ShaderDefines &defines = ShaderDefines()) const;
+
+	//delete the programs of all variants
+	void release();
+
+	size_t getVariantsNum() const { return _variants.size(); }
+	void printStats(std::ostream &os) const;
+
+	//the key of a variant: the paths and the sorted define lines
+	static std::string key(const std::string &vPath, const std::string &fPath, const ShaderDefines &defines);
+
+private:
+	std::unordered_map<std::string, std::unique_ptr<Shader>> _variants;
+	ProgramBinaryCache *_binaries;
+	unsigned long long _hits;
+	unsigned long long _misses;
+};
+
+ShaderCache::ShaderCache(ProgramBinaryCache *binaries) :
+_binaries(binaries),
+_hits(0),
+_misses(0)
+{
+}
+
+std::string ShaderCache::key(const std::string &vPath, const std::string &fPath, const ShaderDefines &defines)
+{
+	return vPath + "\n" + fPath + "\n" + Shader::defineLines(defines);
+}
+
+Shader& ShaderCache::get(const std::string &vPath, const std::string &fPath, const ShaderDefines &defines)
+{
+	std::unique_ptr<Shader> &variant = _variants[key(vPath, fPath, defines)];
+	if (variant)
+	{
+		++_hits;
+		return *variant;
+	}
+	++_misses;
+	variant.reset(new Shader(vPath, fPath, defines, _binaries));
+	return *variant;
+}
+
+Shader* ShaderCache::find(const std::string &vPath, const std::string &fPath, const ShaderDefines &defines) const
+{
+	auto itr = _variants.find(key(vPath, fPath, defines));
+	return itr != _variants.end() ? itr->second.get() : nullptr;
+}
+
+void ShaderCache::release()
+{
+	for (auto &v : _variants)
+		glDeleteProgram(v.second->program);
+	_variants.clear();
+}
+
+void ShaderCache::printStats(std::ostream &os) const
+{
+	os << "Shader cache: " << _variants.size() << " variants, " << _misses << " created, " << _hits << " hits" << std::endl;
+	for (const auto &v : _variants)
+	{
+		os << "  program " << v.second->program << ":";
+		for (const auto &d : v.second->getDefines())
+			os << " " << d.first << (d.second.empty() ? "" : "=") << d.second;
+		os << std::endl;
+	}
+}
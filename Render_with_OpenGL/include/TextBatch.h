@@ -0,0 +1,417 @@
+#pragma once
+
+#include <glad\glad.h>
+#include <glm\glm.hpp>
+
+#include <GlyphMeshStore.h>
+#include <Frustum.h>
+#include <BVH.h>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+//an occurrence of a glyph, text3D.vert reads it from the instance buffer(std430, binding 2)
+struct TextGlyphInstance
+{
+	glm::mat4 model;
+	glm::vec4 color;    //multiplies the ambient and diffuse color of the material
+	GLuint glyph;       //the id of the glyph in the GlyphMeshStore
+	GLuint pad[3];
+};
+static_assert(sizeof(TextGlyphInstance) == 96, "TextGlyphInstance must match the std430 layout of text3D.vert");
+
+//the command layout of glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+//the glyph occurrences of text, their meshes live once in a GlyphMeshStore shared by all batches
+//every occurrence is a record in the instance buffer, the records keep their slots while they live,
+//so changing text rewrites only the changed records
+//the slots are grouped by glyph in an instanced attribute(location 2), a glyph is drawn once with an instance per occurrence:
+//by one glMultiDrawElementsIndirect for all glyphs(opengl 4.3), or by a base vertex/base instance draw per glyph(opengl 4.2)
+//the instance buffer is read as a shader storage buffer, so opengl 4.2 also needs ARB_shader_storage_buffer_object
+//after cull only the occurrences whose bounds intersect the frustum are drawn, a BVH over their bounds is kept for it,
+//the culling runs on the CPU and needs no GL object
+//the GL objects are created at the first draw and must be released while the context is alive
+class TextBatch
+{
+public:
+	static const GLuint NoGlyph = 0xffffffff;
+
+	explicit TextBatch(GlyphMeshStore &store);
+
+	//add an occurrence of a stored glyph, return its slot
+	unsigned int addInstance(unsigned int glyph, const glm::mat4 &model, const glm::vec4 &color = glm::vec4(1.0f));
+	//change an occurrence, nothing is uploaded if it is unchanged
+	void setInstance(unsigned int slot, unsigned int glyph, const glm::mat4 &model, const glm::vec4 &color = glm::vec4(1.0f));
+	void setModel(unsigned int slot, const glm::mat4 &model);
+	void removeInstance(unsigned int slot);
+	const TextGlyphInstance& instance(unsigned int slot) const { return _instances[slot]; }
+
+	//draw only the occurrences in frustum from now on, call it every frame the camera moves
+	void cull(const Frustum &frustum);
+	//draw all occurrences again
+	void disableCulling();
+
+	//draw the occurrences with the current program, return the number of draw calls issued
+	unsigned int draw();
+	void release();
+
+	unsigned int getInstancesNum() const { return _instances.size() - _freeSlots.size(); }
+	//the occurrences drawn and culled by the last cull
+	unsigned int getVisibleNum() const { return _order.size(); }
+	unsigned int getCulledNum() const { return getInstancesNum() - _order.size(); }
+	//the slots grouped by glyph as they are drawn
+	const std::vector<GLuint>& getDrawOrder() const { return _order; }
+	//the distinct glyphs drawn
+	unsigned int getGlyphsNum() const { return _commands.size(); }
+	bool usesMultiDraw() const { return _multiDraw; }
+
+	//the bytes of the GPU buffers of the batch, the meshes are counted by the store
+	size_t memorySize() const;
+	void printStats(std::ostream &os) const;
+
+private:
+	void markInstance(unsigned int slot);
+	void createBuffers();
+	//build the BVH over the world bounds of the live occurrences
+	void buildBVH();
+	//group the slots by glyph and build a command per glyph, slots must be sorted, nullptr means all live slots
+	void buildCommands(const std::vector<GLuint> *slots);
+	void uploadCommands();
+	void uploadInstances();
+
+	GlyphMeshStore &_store;
+
+	std::vector<TextGlyphInstance> _instances;
+	std::vector<unsigned int> _freeSlots;
+	std::vector<GLuint> _order;     //the drawn slots grouped by glyph, all live slots without culling
+	std::vector<DrawElementsIndirectCommand> _commands;
+
+	BVH _bvh;
+	Frustum _frustum;                   //the frustum of the last cull
+	std::vector<GLuint> _visible;
+	bool _culling;
+	bool _bvhDirty;                     //an occurrence was added, removed, moved or changed its glyph
+
+	//the stats of all culls
+	unsigned long long _culls;
+	unsigned long long _cullTests;
+	unsigned long long _culledSum;
+	double _cullTime;                   //seconds
+
+	GLuint _VAO, _instanceBuffer, _orderBuffer, _indirectBuffer;
+	size_t _instanceCapacity;
+	size_t _dirtyFirst, _dirtyLast;     //the records changed since the last upload
+	bool _orderDirty;                   //an occurrence was added, removed or changed its glyph, or moved while culling
+	bool _commandsDirty;                //the draw order or the commands differ from the uploaded ones
+	bool _multiDraw;
+};
+
+TextBatch::TextBatch(GlyphMeshStore &store) :
+_store(store),
+_culling(false), _bvhDirty(false),
+_culls(0), _cullTests(0), _culledSum(0), _cullTime(0.0),
+_VAO(0), _instanceBuffer(0), _orderBuffer(0), _indirectBuffer(0),
+_instanceCapacity(0), _dirtyFirst(0), _dirtyLast(0),
+_orderDirty(false), _commandsDirty(false), _multiDraw(false)
+{
+}
+
+unsigned int TextBatch::addInstance(unsigned int glyph, const glm::mat4 &model, const glm::vec4 &color)
+{
+	unsigned int slot;
+	if (!_freeSlots.empty())
+	{
+		slot = _freeSlots.back();
+		_freeSlots.pop_back();
+	}
+	else
+	{
+		slot = _instances.size();
+		_instances.push_back(TextGlyphInstance());
+	}
+	_instances[slot] = { model, color, glyph, { 0, 0, 0 } };
+	markInstance(slot);
+	_orderDirty = true;
+	_bvhDirty = true;
+	return slot;
+}
+
+void TextBatch::setInstance(unsigned int slot, unsigned int glyph, const glm::mat4 &model, const glm::vec4 &color)
+{
+	if (slot >= _instances.size() || _instances[slot].glyph == NoGlyph) return;
+	TextGlyphInstance &inst = _instances[slot];
+	if (inst.glyph == glyph && inst.model == model && inst.color == color) return;
+
+	if (inst.glyph != glyph)
+		_orderDirty = true;
+	if (inst.glyph != glyph || inst.model != model)
+	{
+		//the draw list of a cull depends on the bounds
+		_bvhDirty = true;
+		_orderDirty |= _culling;
+	}
+	inst.glyph = glyph;
+	inst.model = model;
+	inst.color = color;
+	markInstance(slot);
+}
+
+void TextBatch::setModel(unsigned int slot, const glm::mat4 &model)
+{
+	if (slot >= _instances.size() || _instances[slot].glyph == NoGlyph) return;
+	setInstance(slot, _instances[slot].glyph, model, _instances[slot].color);
+}
+
+void TextBatch::removeInstance(unsigned int slot)
+{
+	if (slot >= _instances.size() || _instances[slot].glyph == NoGlyph) return;
+	//the record stays in the buffer, it is only left out of the draws
+	_instances[slot].glyph = NoGlyph;
+	_freeSlots.push_back(slot);
+	_orderDirty = true;
+	_bvhDirty = true;
+}
+
+void TextBatch::markInstance(unsigned int slot)
+{
+	if (_dirtyFirst == _dirtyLast)
+	{
+		_dirtyFirst = slot;
+		_dirtyLast = slot + 1;
+	}
+	else
+	{
+		_dirtyFirst = std::min<size_t>(_dirtyFirst, slot);
+		_dirtyLast = std::max<size_t>(_dirtyLast, slot + 1);
+	}
+}
+
+unsigned int TextBatch::draw()
+{
+	_store.upload();
+	if (!_VAO)
+		createBuffers();
+	if (_orderDirty)
+	{
+		if (_culling)
+			cull(_frustum);
+		else
+			buildCommands(nullptr);
+	}
+	if (_commandsDirty)
+		uploadCommands();
+	if (_dirtyFirst != _dirtyLast)
+		uploadInstances();
+	if (_commands.empty()) return 0;
+
+	unsigned int drawCalls = 0;
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _instanceBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _store.boundsBuffer());
+	glBindVertexArray(_VAO);
+	if (_multiDraw)
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirectBuffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, _commands.size(), 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		drawCalls = 1;
+	}
+	else
+	{
+		for (const auto &c : _commands)
+		{
+			glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, c.count, GL_UNSIGNED_INT,
+				(void*)(c.firstIndex * sizeof(GLuint)), c.instanceCount, c.baseVertex, c.baseInstance);
+		}
+		drawCalls = _commands.size();
+	}
+	glBindVertexArray(0);
+	return drawCalls;
+}
+
+void TextBatch::createBuffers()
+{
+	_multiDraw = GLAD_GL_VERSION_4_3 != 0;
+	glGenVertexArrays(1, &_VAO);
+	glGenBuffers(1, &_instanceBuffer);
+	glGenBuffers(1, &_orderBuffer);
+	glGenBuffers(1, &_indirectBuffer);
+
+	//the meshes of the store: normalized integers, the positions arrive in [0, 1] and the normal codes in [-1, 1]
+	glBindVertexArray(_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, _store.vertexBuffer());
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _store.indexBuffer());
+	glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(QuantizedVertex), (void*)offsetof(QuantizedVertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(QuantizedVertex), (void*)offsetof(QuantizedVertex, normal));
+	glEnableVertexAttribArray(1);
+
+	//one slot per instance, the baseInstance of a glyph's command points to the first slot of its group
+	glBindBuffer(GL_ARRAY_BUFFER, _orderBuffer);
+	glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	//all records are uploaded to the new buffer
+	_orderDirty = true;
+	_commandsDirty = true;
+	_instanceCapacity = 0;
+	_dirtyFirst = 0;
+	_dirtyLast = _instances.size();
+}
+
+void TextBatch::cull(const Frustum &frustum)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	_culling = true;
+	_frustum = frustum;
+	if (_bvhDirty)
+		buildBVH();
+
+	_visible.clear();
+	_cullTests += _bvh.cull(frustum, _visible);
+	//the draw order of the visible slots is the order of all slots, so an unchanged view uploads nothing
+	std::sort(_visible.begin(), _visible.end());
+	buildCommands(&_visible);
+
+	++_culls;
+	_culledSum += getCulledNum();
+	_cullTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void TextBatch::disableCulling()
+{
+	if (!_culling) return;
+	_culling = false;
+	_orderDirty = true;
+}
+
+void TextBatch::buildBVH()
+{
+	std::vector<BoundingBox> boxes;
+	std::vector<unsigned int> slots;
+	boxes.reserve(getInstancesNum());
+	slots.reserve(getInstancesNum());
+	for (GLuint slot = 0; slot < _instances.size(); ++slot)
+	{
+		const TextGlyphInstance &inst = _instances[slot];
+		if (inst.glyph == NoGlyph) continue;
+		boxes.push_back(_store.bounds(inst.glyph).transform(inst.model));
+		slots.push_back(slot);
+	}
+	_bvh.build(boxes, slots);
+	_bvhDirty = false;
+}
+
+void TextBatch::buildCommands(const std::vector<GLuint> *slots)
+{
+	std::vector<GLuint> live;
+	if (slots == nullptr)
+	{
+		for (GLuint slot = 0; slot < _instances.size(); ++slot)
+			if (_instances[slot].glyph != NoGlyph)
+				live.push_back(slot);
+		slots = &live;
+	}
+
+	//counting sort of the slots by glyph
+	std::vector<GLuint> first(_store.getGlyphsNum() + 1, 0);
+	for (GLuint slot : *slots)
+		++first[_instances[slot].glyph + 1];
+	for (size_t g = 1; g < first.size(); ++g)
+		first[g] += first[g - 1];
+
+	std::vector<DrawElementsIndirectCommand> commands;
+	for (unsigned int g = 0; g < _store.getGlyphsNum(); ++g)
+	{
+		GLuint n = first[g + 1] - first[g];
+		if (n == 0) continue;
+		const StoredGlyph &glyph = _store.glyph(g);
+		commands.push_back({ glyph.indexCount, n, glyph.firstIndex, glyph.baseVertex, first[g] });
+	}
+
+	std::vector<GLuint> order(first.back());
+	for (GLuint slot : *slots)
+		order[first[_instances[slot].glyph]++] = slot;
+
+	auto sameCommand = [](const DrawElementsIndirectCommand &a, const DrawElementsIndirectCommand &b)
+	{
+		return a.count == b.count && a.instanceCount == b.instanceCount && a.firstIndex == b.firstIndex &&
+			a.baseVertex == b.baseVertex && a.baseInstance == b.baseInstance;
+	};
+	if (order != _order || commands.size() != _commands.size() ||
+		!std::equal(commands.begin(), commands.end(), _commands.begin(), sameCommand))
+	{
+		_order.swap(order);
+		_commands.swap(commands);
+		_commandsDirty = true;
+	}
+	_orderDirty = false;
+}
+
+void TextBatch::uploadCommands()
+{
+	glBindBuffer(GL_ARRAY_BUFFER, _orderBuffer);
+	glBufferData(GL_ARRAY_BUFFER, _order.size() * sizeof(GLuint), _order.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	if (_multiDraw)
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, _commands.size() * sizeof(DrawElementsIndirectCommand), _commands.data(), GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+	_commandsDirty = false;
+}
+
+void TextBatch::uploadInstances()
+{
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _instanceBuffer);
+	if (_instances.size() > _instanceCapacity)
+	{
+		//the buffer grows by doubling, all records are uploaded again
+		_instanceCapacity = std::max(_instances.size(), _instanceCapacity * 2);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, _instanceCapacity * sizeof(TextGlyphInstance), nullptr, GL_DYNAMIC_DRAW);
+		_dirtyFirst = 0;
+		_dirtyLast = _instances.size();
+	}
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, _dirtyFirst * sizeof(TextGlyphInstance),
+		(_dirtyLast - _dirtyFirst) * sizeof(TextGlyphInstance), _instances.data() + _dirtyFirst);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	_dirtyFirst = _dirtyLast = 0;
+}
+
+void TextBatch::release()
+{
+	if (!_VAO) return;
+	glDeleteVertexArrays(1, &_VAO);
+	GLuint buffers[] = { _instanceBuffer, _orderBuffer, _indirectBuffer };
+	glDeleteBuffers(3, buffers);
+	_VAO = _instanceBuffer = _orderBuffer = _indirectBuffer = 0;
+	_instanceCapacity = 0;
+}
+
+size_t TextBatch::memorySize() const
+{
+	return _instanceCapacity * sizeof(TextGlyphInstance) + _order.size() * sizeof(GLuint) +
+		(_multiDraw ? _commands.size() * sizeof(DrawElementsIndirectCommand) : 0);
+}
+
+void TextBatch::printStats(std::ostream &os) const
+{
+	os << "Text batch: " << getInstancesNum() << " glyph instances of " << getGlyphsNum() << " glyphs, "
+		<< memorySize() / 1024 << " KB of GPU buffers" << std::endl;
+	if (_culls > 0)
+		os << "  culling: " << double(_culledSum) / _culls << " instances culled, " << double(_cullTests) / _culls << " box tests, "
+			<< _cullTime * 1000.0 / _culls << " ms per cull, BVH of " << _bvh.getNodesNum() << " nodes" << std::endl;
+}
@@ -1,11 +1,21 @@
 #version 420 core
+#extension GL_ARB_shader_storage_buffer_object : require
 
 in vec3 Normal;
 in vec3 FragPos;
-in vec2 TexCoord;
+//the color of the glyph instance, it tints the ambient and diffuse color of the material
+in vec3 Color;
+//the depth of the fragment in view space, it picks the slice of the cluster
+in float ViewDepth;
 
 out vec4 fragColor;
 
+//the switches of the variants, Shader defines them after #version, the defaults give the general variant
+//SPOT_LIGHTS 0: every light of the clusters is a point light, the spot light branch is compiled out
+#ifndef SPOT_LIGHTS
+#define SPOT_LIGHTS 1
+#endif
+
 struct Material
 {
     vec3 ambient;
@@ -14,19 +24,6 @@ struct Material
 	float shininess;
 };
 
-struct Attenuation
-{
-    float constant;
-	float linear;
-	float quadratic;
-};
-
-struct Cutoff
-{
-    float cutoff;
-	float outCutoff;
-};
-
 struct DirectionalLight
 {
     vec3 direction;
@@ -36,44 +33,46 @@ struct DirectionalLight
 	vec3 specular;
 };
 
-struct PointLight
+//a point light or a spot light of LightClusters
+struct Light
 {
-    vec3 position;
-
-	vec3 ambient;
-	vec3 diffuse;
-	vec3 specular;
+    vec4 position;      //w is the radius of the light
+	vec4 direction;     //w is 1 for a spot light, 0 for a point light
 
-	//the attenuation factor
-	Attenuation atten;
-};
+	vec4 ambient;
+	vec4 diffuse;
+	vec4 specular;
 
-struct SpotLight
-{
-    vec3 position;
-	vec3 direction;
+	//the attenuation factor: constant, linear, quadratic
+	vec4 atten;
 
-	vec3 ambient;
-	vec3 diffuse;
-	vec3 specular;
-
-	//the attenuation factor
-	Attenuation atten;
-
-	//cutoff angle
-	Cutoff co;
+	//cutoff angle: inner, outer
+	vec4 co;
 };
 
-const int PointLightNum = 1;
-const int SpotLightNum = 1;
-
 uniform Material material;
 
 layout(std140, binding = 1) uniform Lights
 {
     DirectionalLight dirLight;
-    PointLight pointLights[PointLightNum];
-    SpotLight torch[SpotLightNum];
+	uvec4 clusterGrid;      //the clusters along x, y and z, w is the number of lights
+	vec4 clusterParams;     //the clusters per pixel along x and y, the scale and bias from log(view depth) to the slice
+};
+
+layout(std430, binding = 4) readonly buffer LightData
+{
+    Light lights[];
+};
+
+//the offset and the count of the light indices of every cluster
+layout(std430, binding = 5) readonly buffer ClusterData
+{
+    uvec2 clusters[];
+};
+
+layout(std430, binding = 6) readonly buffer LightIndexData
+{
+    uint lightIndices[];
 };
 
 uniform vec3 viewPos;
@@ -82,17 +81,31 @@ float diff(vec3 lightDir, vec3 normal);
 float spec(vec3 lightDir, vec3 normal, vec3 viewDir, float shininess);
 
 vec3 calcDirLight(DirectionalLight light, vec3 normal, vec3 viewPos);
-vec3 calcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewPos);
-vec3 calcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewPos);
+vec3 calcPointLight(Light light, vec3 normal, vec3 fragPos, vec3 viewPos);
+vec3 calcSpotLight(Light light, vec3 normal, vec3 fragPos, vec3 viewPos);
 
 void main()
 {
-    vec3 result;
+    vec3 result = vec3(0.0f);
     result += calcDirLight(dirLight, Normal, viewPos);
-	for(int i = 0; i < PointLightNum; ++i)
-	    result += calcPointLight(pointLights[i], Normal, FragPos, viewPos);
-	for(int i = 0; i < SpotLightNum; ++i)
-	    result += calcSpotLight(torch[i], Normal, FragPos, viewPos);
+
+	//only the lights binned into the cluster of the fragment
+	uvec3 cell = uvec3(uvec2(gl_FragCoord.xy * clusterParams.xy), uint(max(log(ViewDepth) * clusterParams.z + clusterParams.w, 0.0f)));
+	cell = min(cell, clusterGrid.xyz - 1u);
+	uvec2 range = clusters[cell.x + clusterGrid.x * (cell.y + clusterGrid.y * cell.z)];
+	for(uint i = 0u; i < range.y; ++i)
+	{
+	    Light light = lights[lightIndices[range.x + i]];
+		//the lights are binned by their radius, beyond it a light is cut off, so the clusters don't change the image
+		if (distance(light.position.xyz, FragPos) > light.position.w)
+		    continue;
+#if SPOT_LIGHTS
+		if (light.direction.w > 0.5f)
+		    result += calcSpotLight(light, Normal, FragPos, viewPos);
+		else
+#endif
+		    result += calcPointLight(light, Normal, FragPos, viewPos);
+	}
 
     fragColor = vec4(result, 1.0f);
 }
@@ -113,48 +126,48 @@ vec3 calcDirLight(DirectionalLight light, vec3 normal, vec3 viewPos)
     vec3 ld = normalize(-light.direction);
 	vec3 n = normalize(normal);
 	vec3 vd = normalize(viewPos - FragPos);
-    vec3 ambient = light.ambient * material.ambient;
-	vec3 diffuse = light.diffuse * diff(ld, n) * material.diffuse;
+    vec3 ambient = light.ambient * material.ambient * Color;
+	vec3 diffuse = light.diffuse * diff(ld, n) * material.diffuse * Color;
 	vec3 specular = light.specular * spec(ld, n, vd, material.shininess) * material.specular;
 
 	return ambient + diffuse + specular;
 }
 
-vec3 calcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewPos)
+vec3 calcPointLight(Light light, vec3 normal, vec3 fragPos, vec3 viewPos)
 {
-    vec3 ld = normalize(light.position - fragPos);
+    vec3 ld = normalize(light.position.xyz - fragPos);
 	vec3 n = normalize(normal);
 	vec3 vd = normalize(viewPos - FragPos);
 
 	//calculate attenuation
-	float d = length(light.position - fragPos);
-	float atten = 1.0f / (light.atten.constant + light.atten.linear * d + light.atten.quadratic * d * d);
+	float d = length(light.position.xyz - fragPos);
+	float atten = 1.0f / (light.atten.x + light.atten.y * d + light.atten.z * d * d);
 
-	vec3 ambient = light.ambient * material.ambient;
-	vec3 diffuse = light.diffuse * diff(ld, n) * material.diffuse;
-	vec3 specular = light.specular * spec(ld, n, vd, material.shininess) * material.specular;
+	vec3 ambient = light.ambient.rgb * material.ambient * Color;
+	vec3 diffuse = light.diffuse.rgb * diff(ld, n) * material.diffuse * Color;
+	vec3 specular = light.specular.rgb * spec(ld, n, vd, material.shininess) * material.specular;
 
 	return (ambient + diffuse + specular) * atten;
 }
 
-vec3 calcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewPos)
+vec3 calcSpotLight(Light light, vec3 normal, vec3 fragPos, vec3 viewPos)
 {
-    vec3 ld = normalize(light.position - fragPos);
+    vec3 ld = normalize(light.position.xyz - fragPos);
 	vec3 n = normalize(normal);
 	vec3 vd = normalize(viewPos - FragPos);
 
 	//calculate cutoff
-	float theta = dot(-ld, light.direction);
-	float epsilon = light.co.cutoff - light.co.outCutoff;
-	float iten = clamp((theta - light.co.outCutoff) / epsilon, 0.0f, 1.0f);
+	float theta = dot(-ld, light.direction.xyz);
+	float epsilon = light.co.x - light.co.y;
+	float iten = clamp((theta - light.co.y) / epsilon, 0.0f, 1.0f);
 
 	//calculate attenuation
-	float d = length(light.position - fragPos);
-	float atten = 1.0f / (light.atten.constant + light.atten.linear * d + light.atten.quadratic * d * d);
+	float d = length(light.position.xyz - fragPos);
+	float atten = 1.0f / (light.atten.x + light.atten.y * d + light.atten.z * d * d);
 
-	vec3 ambient = light.ambient * material.ambient;
-	vec3 diffuse = light.diffuse * diff(ld, n) * material.diffuse;
-	vec3 specular = light.specular * spec(ld, n, vd, material.shininess) * material.specular;
+	vec3 ambient = light.ambient.rgb * material.ambient * Color;
+	vec3 diffuse = light.diffuse.rgb * diff(ld, n) * material.diffuse * Color;
+	vec3 specular = light.specular.rgb * spec(ld, n, vd, material.shininess) * material.specular;
 
 	return (ambient + (diffuse + specular) * iten) * atten;
 }
\ No newline at end of file
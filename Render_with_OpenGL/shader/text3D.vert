@@ -1,24 +1,64 @@
 #version 420 core
+#extension GL_ARB_shader_storage_buffer_object : require
 
+//the QuantizedVertex of GlyphMeshStore: unorm16 positions in the bounds of the glyph, octahedral snorm16 normals
 layout(location = 0) in vec3 vPosition;
-layout(location = 1) in vec3 vNormal;
-layout(location = 2) in vec2 vTexCoord;
+layout(location = 1) in vec2 vNormal;
+//the slot of the instance in the TextGlyphInstance buffer of TextBatch
+layout(location = 2) in uint vSlot;
+
+struct GlyphInstance
+{
+	mat4 model;
+	vec4 color;
+	uint glyph;
+};
+
+struct GlyphBounds
+{
+	vec4 positionOffset;
+	vec4 positionScale;
+};
+
+layout(std430, binding = 2) readonly buffer Instances
+{
+	GlyphInstance instances[];
+};
+
+layout(std430, binding = 3) readonly buffer Glyphs
+{
+	GlyphBounds glyphs[];
+};
 
 out vec3 Normal;
 out vec3 FragPos;
-out vec2 TexCoord;
+out vec3 Color;
+out float ViewDepth;
 
-uniform mat4 model;
 layout(std140, binding = 0) uniform Matrix
 {
     mat4 view;
     mat4 projection;
 };
 
+vec3 octDecode(vec2 e)
+{
+	vec3 n = vec3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	if (n.z < 0.0f)
+		n.xy = (1.0f - abs(e.yx)) * vec2(e.x >= 0.0f ? 1.0f : -1.0f, e.y >= 0.0f ? 1.0f : -1.0f);
+	return normalize(n);
+}
+
 void main()
 {
-	gl_Position = projection * view * model * vec4(vPosition, 1.0f);
-	FragPos = vec3(model * vec4(vPosition, 1.0f));
-	Normal = mat3(model) * vNormal;
-	TexCoord = vTexCoord;
+	GlyphInstance inst = instances[vSlot];
+	GlyphBounds bounds = glyphs[inst.glyph];
+	vec3 position = bounds.positionOffset.xyz + bounds.positionScale.xyz * vPosition;
+	vec4 worldPos = inst.model * vec4(position, 1.0f);
+	vec4 viewPos = view * worldPos;
+	gl_Position = projection * viewPos;
+	FragPos = vec3(worldPos);
+	ViewDepth = -viewPos.z;
+	Normal = mat3(inst.model) * octDecode(vNormal);
+	Color = inst.color.rgb;
 }
\ No newline at end of file
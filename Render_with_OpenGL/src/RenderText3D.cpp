@@ -8,34 +8,47 @@
 #include <stb_image.h>
 
 #include <Shader.h>
+#include <ShaderCache.h>
+#include <ProgramBinaryCache.h>
 #include <Camera.h>
 #include <Light.h>
+#include <FrameConstants.h>
+#include <LightClusters.h>
 #include <Texture2D.h>
-#include <Mesh.h>
+#include <GlyphMeshStore.h>
+#include <TextBatch.h>
+#include <Frustum.h>
+#include <FrameStats.h>
+#include <GLCallCounter.h>
 
 #include <Glyph3D.h>
 #include <FreeTypeFont.h>
 #include <Tessellator.h>
+#include <GlyphMeshCache.h>
+#include <GlyphPack.h>
+#include <GlyphBuilder.h>
+#include <VertexQuantizer.h>
 
 #include <iostream>
 #include <cmath>
+#include <string>
 #include <vector>
 
 //window's width and height
 GLuint WIDTH = 800;
 GLuint HEIGHT = 600;
 
-enum Uniform_IDs{ lights, VPmatrix, NumUniforms };
 enum Attrib_Ids{ vPostion, vNormal, vTexCoord };
 
-GLuint Uniforms[NumUniforms];
-
 glm::vec3 cameraPos(0.0f, 1.0f, 5.0f);
 FreeCamera camera(cameraPos);
 
 glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
 glm::vec3 lightColor(1.0f, 1.0f, 1.0f);
 
+//the torch is switched on and off by the key F
+bool torchOn = true;
+
 GLfloat deltaTime = 0.0f;
 GLfloat lastTime = 0.0f;
 
@@ -44,19 +57,12 @@ bool firstMouse = true;
 GLfloat lastX = GLfloat(WIDTH) / 2;
 GLfloat lastY = GLfloat(HEIGHT) / 2;
 
-const GLint PointLightNum = 1;
-const GLint SpotLightNum = 1;
-
-const glm::vec3 pointLightPositions[PointLightNum] =
+//the point lights are binned into clusters with the torch, so their number isn't limited by the shader
+const glm::vec3 pointLightPositions[] =
 {
 	glm::vec3(0.2f, 0.6f, 3.0f),
 };
 
-const glm::vec3 spotLightPositions[SpotLightNum] =
-{
-	glm::vec3(0.0f, 4.5f, 0.0f)
-};
-
 //initialize GLFW window option
 void initWindowOption();
 //process input
@@ -65,17 +71,24 @@ void processInput(GLFWwindow *window);
 void framebufferSizeCallback(GLFWwindow *window, int width, int height);
 void mouseCallback(GLFWwindow *window, double x, double y);
 void scrollCallback(GLFWwindow *window, double x, double y);
+void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
 
-int main()
+int main(int argc, char **argv)
 {
-	std::cout << "OpenGL 3.3 GO! Let's make some fun!" << std::endl;
+	std::cout << "OpenGL 4.3 GO! Let's make some fun!" << std::endl;
 
 	initWindowOption();
 	//create a glfw window object
 	GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "GLFW Window", nullptr, nullptr);
 	if (window == nullptr)
 	{
-		std::cerr << "Failed to create GLFW window!";
+		//without opengl 4.3 TextBatch draws every glyph by itself
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+		window = glfwCreateWindow(WIDTH, HEIGHT, "GLFW Window", nullptr, nullptr);
+	}
+	if (window == nullptr)
+	{
+		std::cerr << "Failed to create GLFW window, OpenGL 4.2 or later is required!" << std::endl;
 		glfwTerminate();
 		std::abort();
 	}
@@ -87,69 +100,183 @@ int main()
 		std::cerr << "Failed to init glad!";
 		std::abort();
 	}
+	//the glyph instances are read from shader storage buffers, opengl 4.2 with ARB_shader_storage_buffer_object is the least
+	if (!GLAD_GL_VERSION_4_2)
+	{
+		std::cerr << "OpenGL 4.2 or later is required, the context is OpenGL " << glGetString(GL_VERSION) << std::endl;
+		glfwTerminate();
+		std::abort();
+	}
+	//count the GL calls of every frame with --count-gl-calls, every hooked call goes through a wrapper then
+	bool countGLCalls = false;
+	for (int i = 1; i < argc; ++i)
+		if (std::string(argv[i]) == "--count-gl-calls")
+			countGLCalls = true;
+	if (countGLCalls)
+		GLCallCounter::install();
 
 	//create viewport
 	int width, height;
 	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
+	WIDTH = width;
+	HEIGHT = height;
 	//set background color
 	glClearColor(1.0, 1.0, 1.0, 1.0);
 	//set callback
 	glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
 	glfwSetCursorPosCallback(window, mouseCallback);
 	glfwSetScrollCallback(window, scrollCallback);
+	glfwSetKeyCallback(window, keyCallback);
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 	/////////////////////////////////////////Objects//////////////////////////////////////////////////
 	//Ҫʾּ
-	std::vector<GLuint> advances;
-	std::vector<Mesh> string3D;
+	//every distinct glyph is stored once, the characters of the string are instances of the stored glyphs
+	GlyphMeshStore glyphStore;
+	TextBatch string3D(glyphStore);
+	auto glyphModel = [](GLuint pen)
+	{
+		glm::mat4 model;
+		model = glm::translate(model, glm::vec3(-0.9 + pen * 0.05f, 0.6f, 0.0f));
+		return glm::scale(model, glm::vec3(0.05f, 0.05f, 0.05f));
+	};
 
 	std::wstring text = L"ʡIPOC OSG";
 
+	//the font file is opened once and shared by all characters
+	FontRegistry fonts;
+	FontFace *font = fonts.getFace("../fonts/stxinwei.ttf");
+	if (font == nullptr)
+	{
+		std::cerr << "Failed to load font!";
+		glfwTerminate();
+		std::abort();
+	}
+	GlyphMeshCache meshCache;
+
+	//the settings the meshes of the string are built with
+	const float glyphTolerance = FreeType::DefaultTolerance;
+	const float glyphDepth = 3.0f;
+	const float glyphCreaseAngle = DefaultCreaseAngle;
+
+	//the meshes baked to a glyph pack are quantized already, they are stored straight from the mapped file
+	//a pack baked with other settings or from another font would mix other meshes into the string, so it is ignored
+	GlyphPack pack;
+	if (pack.open("../fonts/stxinwei.t3gp"))
+	{
+		const GlyphPackHeader &header = pack.header();
+		bool matches = header.pixelSize == font->pixelSize && header.tolerance == glyphTolerance &&
+			header.depth == glyphDepth && header.creaseAngle == glyphCreaseAngle;
+		for (const auto &c : text)
+		{
+			FT_UInt index = pack.glyphIndex(c);
+			if (index != 0 && index != font->glyphIndex(c))
+				matches = false;
+		}
+		if (!matches)
+		{
+			std::cout << "GlyphPack: ../fonts/stxinwei.t3gp doesn't match the font or the mesh settings, it is ignored" << std::endl;
+			pack.close();
+		}
+	}
+
+	//the characters missing from the pack are built on all cores, repeated characters are built only once
+	std::vector<FT_ULong> unbaked;
+	for (const auto &c : text)
+		if (c != ' ' && !pack.findGlyph(pack.glyphIndex(c)))
+			unbaked.push_back(c);
+	GlyphBuilder builder(fonts);
+	std::vector<std::shared_ptr<const GlyphMesh>> meshes = builder.build(font, unbaked, glyphTolerance, glyphDepth, glyphCreaseAngle, &meshCache);
+	size_t nextMesh = 0;
+
+	//store the glyphs of the string, the stored glyph id and the advance of every character
+	std::vector<int> charGlyphs;
+	std::vector<GLuint> charAdvances;
+	GLuint lastAdvance = 0;
 	for (const auto &c : text)
 	{
 		//ȡϢ
+		int glyph = -1;
 		if (c == ' ')
 		{
-			advances.back() *= 2;
+			charGlyphs.push_back(glyph);
+			charAdvances.push_back(lastAdvance);
 			continue;
 		}
-		FreeTypeFont temp_char(c, "../fonts/stxinwei.ttf");
-		//ÿεĲ
-		advances.push_back(temp_char.advanceX());
-		//ϢƵԪ
-		Glyph3D glyph = temp_char.getGlyph3D();
-		//3Dģ
-		computeGlyphGeometry(glyph, 3.0);
-
-		std::vector<glm::vec3> normals = glyph.getNormalArray();
-		ElementArray indices = glyph.getIndices();
-		std::vector<Vertex> verts(indices.size());
-
-		for (size_t i = 0; i < indices.size(); ++i)
-			verts.push_back({ glyph._vertices[indices[i]], normals[i], glm::vec2() });
-
-		string3D.emplace_back(verts);
-		//
-		//glyph.output();
+		const GlyphPackEntry *entry = pack.findGlyph(pack.glyphIndex(c));
+		if (entry)
+		{
+			glyph = glyphStore.add(GlyphMeshStore::key(font->id, entry->glyphIndex), pack.vertices(*entry), entry->vertexCount,
+				pack.indices(*entry), entry->indexCount, GlyphPack::bounds(*entry));
+			lastAdvance = entry->advanceX;
+		}
+		else if (std::shared_ptr<const GlyphMesh> mesh = meshes[nextMesh++])
+		{
+			unsigned long long key = GlyphMeshStore::key(font->id, font->glyphIndex(c));
+			glyph = glyphStore.find(key);
+			if (glyph < 0)
+			{
+				//the glyph mesh is indexed, its vertices are quantized before they are stored
+				std::vector<QuantizedVertex> verts;
+				QuantizationBounds bounds = quantizeGlyph(mesh->glyph, verts);
+				const std::vector<GLuint> &indices = mesh->glyph.getIndices();
+				glyph = glyphStore.add(key, verts.data(), verts.size(), indices.data(), indices.size(), bounds);
+			}
+			//ÿεĲ
+			lastAdvance = mesh->advanceX;
+		}
+		charGlyphs.push_back(glyph);
+		charAdvances.push_back(glyph < 0 ? 0 : lastAdvance);
 	}
 
-	////////////////////////////////////////Shaders/////////////////////////////////////////////////////
-	Shader textShader("shader/text3D.vert", "shader/text3D.frag");
+	//lay the characters out as instances, a later layout of changed text reuses the slots,
+	//only the instances whose glyph or position changed are uploaded again
+	std::vector<unsigned int> charSlots;
+	auto layoutText = [&]()
+	{
+		size_t n = 0;
+		GLuint pen = 0;
+		for (size_t i = 0; i < charGlyphs.size(); ++i)
+		{
+			if (charGlyphs[i] >= 0)
+			{
+				if (n < charSlots.size())
+					string3D.setInstance(charSlots[n], charGlyphs[i], glyphModel(pen));
+				else
+					charSlots.push_back(string3D.addInstance(charGlyphs[i], glyphModel(pen)));
+				++n;
+			}
+			pen += charAdvances[i];
+		}
+		for (size_t i = n; i < charSlots.size(); ++i)
+			string3D.removeInstance(charSlots[i]);
+		charSlots.resize(n);
+	};
+	layoutText();
 
+	fonts.printStats(std::cout);
+	meshCache.printStats(std::cout);
+	builder.printStats(std::cout);
 
-	//create lights ubo
-	glGenBuffers(NumUniforms, Uniforms);
-	glBindBuffer(GL_UNIFORM_BUFFER, Uniforms[lights]);
-	glBufferData(GL_UNIFORM_BUFFER, 64 + PointLightNum * 80 + SpotLightNum * 112, nullptr, GL_STATIC_DRAW);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 1, Uniforms[lights]);
+	////////////////////////////////////////Shaders/////////////////////////////////////////////////////
+	//the text shader is specialized by the lights of the frame: [0] point lights only, [1] point lights and spot lights
+	//the linked programs are cached next to the shaders, a later run loads them instead of compiling
+	double shadersStart = glfwGetTime();
+	ProgramBinaryCache programBinaries("shader/");
+	ShaderCache shaders(&programBinaries);
+	Shader *textShaders[2] =
+	{
+		&shaders.get("shader/text3D.vert", "shader/text3D.frag", { { "SPOT_LIGHTS", "0" } }),
+		&shaders.get("shader/text3D.vert", "shader/text3D.frag", { { "SPOT_LIGHTS", "1" } })
+	};
+	std::cout << "Shaders ready in " << (glfwGetTime() - shadersStart) * 1000.0 << " ms" << std::endl;
+	programBinaries.printStats(std::cout);
+	UniformHandle<glm::vec3> viewPosUniforms[2];
 
-	glBindBuffer(GL_UNIFORM_BUFFER, Uniforms[VPmatrix]);
-	glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), nullptr, GL_STATIC_DRAW);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, Uniforms[VPmatrix]);
+	//the Matrix and Lights blocks of every frame
+	FrameConstants<LightsBlock> frameConstants;
+	LightClusters lightClusters;
 
 	//////////////////////////////////////////////Lights////////////////////////////////////////////////////
 	//directional light
@@ -161,56 +288,58 @@ int main()
 		glm::vec3(0.5f, 0.5f, 0.5f)
 	};
 	//point lights
-	std::vector<PointLight> pLights;
-	for (size_t i = 0; i < PointLightNum; ++i)
+	for (const auto &position : pointLightPositions)
 	{
 		PointLight pLight
 		{
-			pointLightPositions[i],
+			position,
 			glm::vec3(0.05f, 0.05f, 0.05f),
 			glm::vec3(0.8f, 0.8f, 0.8f),
 			glm::vec3(1.0f, 1.0f, 1.0f),
 			{ 1.0f, 0.09f, 0.032f }
 		};
-		pLights.push_back(pLight);
+		lightClusters.lights.push_back(pLight.block());
 	}
-	//spot lights
-	std::vector<SpotLight> sLights;
-	for (size_t i = 0; i < SpotLightNum; ++i)
+	//the torch follows the camera
+	SpotLight torch
 	{
-		SpotLight torch
-		{
-			camera.position,
-			glm::vec3(0.0f, -1.0f, 0.0f),
-			glm::vec3(0.0f, 0.0f, 0.0f),
-			glm::vec3(0.5f, 0.5f, 0.5f),
-			glm::vec3(1.0f, 1.0f, 1.0f),
-			{ 1.0f, 0.09f, 0.032f },
-			{ glm::cos(glm::radians(8.0f)), glm::cos(glm::radians(15.0f)) }
-		};
-		sLights.push_back(torch);
-	}
+		camera.position,
+		glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 0.0f),
+		glm::vec3(0.5f, 0.5f, 0.5f),
+		glm::vec3(1.0f, 1.0f, 1.0f),
+		{ 1.0f, 0.09f, 0.032f },
+		{ glm::cos(glm::radians(8.0f)), glm::cos(glm::radians(15.0f)) }
+	};
+	size_t torchLight = lightClusters.lights.size();
+	lightClusters.lights.push_back(torch.block());
 
 	//set the lights uniform
-	dLight.setUniform(Uniforms[lights], 0);
-	for (size_t i = 0; i < PointLightNum; ++i)
-	{
-		GLuint baseOffset = 64 + i * 80;
-		pLights[i].setUniform(Uniforms[lights], baseOffset);
-	}
+	frameConstants.lights.dirLight = dLight.block();
 	
 	//////////////////////////////////////////////Materials////////////////////////////////////////////////////
-	textShader.use();
-	textShader.setUniformVec3("material.ambient", glm::vec3(1.0f, 1.0f, 0.0f));
-	textShader.setUniformVec3("material.diffuse", glm::vec3(1.0f, 1.0f, 0.0f));
-	textShader.setUniformVec3("material.specular", glm::vec3(0.5f, 0.5f, 0.5f));
-	textShader.setUniformFloat("material.shininess", 500.0f);
+	//the uniforms belong to a program, so every variant gets the material
+	for (int i = 0; i < 2; ++i)
+	{
+		Shader &textShader = *textShaders[i];
+		frameConstants.checkLayout(textShader);
+		viewPosUniforms[i] = textShader.uniform<glm::vec3>("viewPos");
+		textShader.use();
+		textShader.setUniformVec3("material.ambient", glm::vec3(1.0f, 1.0f, 0.0f));
+		textShader.setUniformVec3("material.diffuse", glm::vec3(1.0f, 1.0f, 0.0f));
+		textShader.setUniformVec3("material.specular", glm::vec3(0.5f, 0.5f, 0.5f));
+		textShader.setUniformFloat("material.shininess", 500.0f);
+	}
 
 	glEnable(GL_DEPTH_TEST);
 
 	///////////////////////////////////////////////////Game Loop////////////////////////////////////////////////
+	FrameStats frameStats;
+	unsigned long long frames = 0;
+	GLCallCounter::reset();
 	while (!glfwWindowShouldClose(window))
 	{
+		frameStats.beginFrame();
 		GLfloat currTime = glfwGetTime();
 		deltaTime = currTime - lastTime;
 		lastTime = currTime;
@@ -225,33 +354,47 @@ int main()
 		glm::mat4 view = camera.getViewMatrix();
 		glm::mat4 proj = glm::perspective(glm::radians(camera.zoom), (GLfloat)WIDTH / HEIGHT, 0.1f, 100.0f);
 
-		glBindBuffer(GL_UNIFORM_BUFFER, Uniforms[VPmatrix]);
-		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(view));
-		glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(proj));
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-		
-		sLights[0].position = camera.position;
-		sLights[0].direction = camera.front;
-		GLuint baseOffset = 64 + PointLightNum * 80;
-		sLights[0].setUniform(Uniforms[lights], baseOffset);
-
-		textShader.use();
-		textShader.setUniformVec3("viewPos", camera.position);
-		for (size_t i = 0, advance = 0; i < string3D.size(); advance += advances[i], ++i)
-		{
-			glm::mat4 model;
-			model = glm::translate(model, glm::vec3(-0.9 + advance * 0.05f, 0.6f, 0.0f));
-			model = glm::scale(model, glm::vec3(0.05f, 0.05f, 0.05f));
-			textShader.setUniformMat4("model", model);
-
-			string3D[i].draw(textShader);
-		}
+		frameConstants.matrix.view = view;
+		frameConstants.matrix.projection = proj;
+
+		torch.position = camera.position;
+		torch.direction = camera.front;
+		lightClusters.lights.resize(torchOn ? torchLight + 1 : torchLight);
+		if (torchOn)
+			lightClusters.lights[torchLight] = torch.block();
+		lightClusters.build(view, proj, 0.1f, 100.0f, WIDTH, HEIGHT);
+		lightClusters.setBlock(frameConstants.lights);
+		lightClusters.upload();
+		frameConstants.upload();
+
+		//the spot light branch is compiled only into the variant used when a spot light is in view
+		int variant = lightClusters.getSpotLightsNum() > 0 ? 1 : 0;
+		textShaders[variant]->use();
+		textShaders[variant]->set(viewPosUniforms[variant], camera.position);
+		//only the glyphs in the view reach the draw list
+		string3D.cull(Frustum(proj * view));
+		frameStats.addDrawCalls(string3D.draw());
+		frameConstants.endFrame();
+		frameStats.endFrame();
+		++frames;
 
 		//swap frame buffer
 		glfwSwapBuffers(window);
+		frameStats.report(std::cout);
 	}
-
+	frameStats.print(std::cout);
+	if (countGLCalls)
+		GLCallCounter::print(std::cout, frames);
+
+	glyphStore.printStats(std::cout);
+	string3D.printStats(std::cout);
+	string3D.release();
+	glyphStore.release();
+	frameConstants.release();
+	lightClusters.printStats(std::cout);
+	lightClusters.release();
+	shaders.printStats(std::cout);
+	shaders.release();
 	glfwTerminate();
 
 	std::cout << "Done!" << std::endl;
@@ -262,7 +405,8 @@ int main()
 void initWindowOption()
 {
 	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	//opengl 4.3 draws all glyphs by one glMultiDrawElementsIndirect, see TextBatch
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	//we have no need to use the compatibility profile
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -287,6 +431,9 @@ void processInput(GLFWwindow *window)
 void framebufferSizeCallback(GLFWwindow *window, int width, int height)
 {
 	glViewport(0, 0, width, height);
+	//the projection and the clusters follow the framebuffer
+	WIDTH = width;
+	HEIGHT = height;
 }
 
 void mouseCallback(GLFWwindow *window, double x, double y)
@@ -310,4 +457,10 @@ void mouseCallback(GLFWwindow *window, double x, double y)
 void scrollCallback(GLFWwindow *window, double x, double y)
 {
 	camera.processMouseScroll(y);
+}
+
+void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
+{
+	if (key == GLFW_KEY_F && action == GLFW_PRESS)
+		torchOn = !torchOn;
 }
\ No newline at end of file
@@ -0,0 +1,40 @@
+//batched evaluation of Bezier curve samples used to flatten glyph outlines
+//after adaptive flattening most curves need only one to three segments, so the kernels work across curves:
+//each SIMD lane evaluates one curve, 8 curves at a time with AVX and 4 with SSE, otherwise in a scalar loop
+#pragma once
+
+#include <vector>
+
+#include <glm\glm.hpp>
+
+//conic and cubic Bezier curves in power basis, p(u) = ((a*u + b)*u + c)*u + d, stored as structure of arrays
+//a conic Bezier is stored with a = 0, so its evaluation has no rational weight divide
+struct BezierBatch
+{
+	std::vector<float> ax, ay, bx, by, cx, cy, dx, dy;
+	std::vector<unsigned int> steps;   //number of line segments, the samples are u = i/steps for i in [1, steps)
+	std::vector<unsigned int> first;   //index of the first sample of the curve in the output buffer
+	unsigned int num_samples;          //total number of samples of all curves
+
+	BezierBatch() : num_samples(0) {}
+
+	unsigned int size() const { return steps.size(); }
+	void reserve(unsigned int n);
+	void clear();
+
+	//append a curve and return its index in the batch
+	unsigned int addConic(const glm::vec2 &p0, const glm::vec2 &p1, const glm::vec2 &p2, unsigned int num_steps);
+	unsigned int addCubic(const glm::vec2 &p0, const glm::vec2 &p1, const glm::vec2 &p2, const glm::vec2 &p3, unsigned int num_steps);
+
+private:
+	unsigned int add(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c, const glm::vec2 &d, unsigned int num_steps);
+};
+
+//evaluate the inner samples of every curve into samples[first], samples[first + 1] ... samples[first + steps - 2]
+//samples must have room for batch.num_samples points
+//the SIMD kernels compute the same operations in the same order as the scalar loop, so their results are bit-identical
+void evaluateBezierBatch(const BezierBatch &batch, glm::vec2 *samples);
+void evaluateBezierBatchScalar(const BezierBatch &batch, glm::vec2 *samples);
+
+//the name of the kernel selected at compile time("AVX", "SSE" or "scalar")
+const char* bezierKernelName();
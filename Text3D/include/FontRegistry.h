@@ -0,0 +1,93 @@
+//a long-lived registry of font faces
+//every font file is memory mapped only once and all faces created from the same file read the same mapping,
+//faces are handed out by (font file, face index, pixel size)
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+//FreeType
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "MappedFile.h"
+
+//a font file mapped to memory, FreeType reads the font tables straight from the mapping
+struct FontFile
+{
+	std::string path;
+	MappedFile mapping;
+	double mapTime;        //milliseconds spent to map the file
+};
+
+//a face of a font file which has been set to a pixel size
+struct FontFace
+{
+	unsigned int id;       //id of (font file, face index, pixel size) in its registry, faces of other threads share it
+	FontFile *file;        //the font file that the face created from
+	FT_Long faceIndex;
+	FT_UInt pixelSize;
+	FT_Face face;
+	double openTime;       //milliseconds spent to open and size the face
+
+	//the glyph index of a character code, 0 means the font has no glyph for this character
+	FT_UInt glyphIndex(FT_ULong charcode) const { return FT_Get_Char_Index(face, charcode); }
+};
+
+class FontRegistry
+{
+public:
+	FontRegistry();
+	~FontRegistry();
+
+	FontRegistry(const FontRegistry&) = delete;
+	FontRegistry& operator=(const FontRegistry&) = delete;
+
+	//return the shared face of (font_file, face_index, pixel_size), the face and its font file will be opened at the first time
+	//return nullptr if the font file can't be loaded
+	//a FT_Face must not be used by two threads at the same time, worker threads should use createFace instead
+	FontFace* getFace(const std::string &font_file, FT_Long face_index = 0, FT_UInt pixel_size = 24);
+
+	//create a private face for one worker thread, it reads the same mapping as every other face of the file
+	//the face is owned by the registry, call releaseFace when the thread no longer needs it
+	FontFace* createFace(const std::string &font_file, FT_Long face_index = 0, FT_UInt pixel_size = 24);
+	void releaseFace(FontFace *font_face);
+
+	FT_Library getLibrary() const { return _ft; }
+	unsigned int getFilesNum() const { return _files.size(); }
+	unsigned int getFacesNum() const { return _faces.size(); }
+
+	//output the mapped size, resident memory and open time of every font file
+	void printStats(std::ostream &os) const;
+
+private:
+	FontFile* getFile(const std::string &font_file);
+	FontFace* openFace(FontFile *file, FT_Long face_index, FT_UInt pixel_size);
+	unsigned int getFaceId(const std::string &font_file, FT_Long face_index, FT_UInt pixel_size);
+
+	struct FaceKey
+	{
+		std::string file;
+		FT_Long faceIndex;
+		FT_UInt pixelSize;
+
+		bool operator<(const FaceKey &rhs) const
+		{
+			if (file != rhs.file) return file < rhs.file;
+			if (faceIndex != rhs.faceIndex) return faceIndex < rhs.faceIndex;
+			return pixelSize < rhs.pixelSize;
+		}
+	};
+
+	FT_Library _ft;
+	std::map<std::string, FontFile*> _files;
+	std::map<FaceKey, FontFace*> _faces;
+	std::vector<FontFace*> _threadFaces;
+	std::map<FaceKey, unsigned int> _faceIds;
+
+	//FT_Library is not thread safe, opening and closing faces are serialized by this mutex
+	mutable std::mutex _mutex;
+};
@@ -6,6 +6,8 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <cmath>
+#include <algorithm>
 
 //glm
 #include <glm\glm.hpp>
@@ -14,41 +16,116 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_OUTLINE_H
+#include FT_GLYPH_H
 
+#include "FontRegistry.h"
+#include "BezierKernel.h"
 #include "Glyph3D.h"
 
 namespace FreeType
 {
+	//the default flattening tolerance, 1/16 pixel
+	const float DefaultTolerance = 4.0f;
+
+	//the number of segments needed to flatten a Bezier whose second derivative is not longer than dd,
+	//the distance between the curve and a chord of parameter length h is at most h*h*dd/8
+	inline unsigned int flatteningSteps(float dd, float tolerance, unsigned int max_steps)
+	{
+		if (tolerance <= 0.0f) return max_steps;
+		float n = std::ceil(std::sqrt(dd / (8.0f * tolerance)));
+		if (n < 1.0f) return 1;
+		if (n > max_steps) return max_steps;
+		return (unsigned int)n;
+	}
+
 	//this class used to store the vertices and contour list of the original glyph
 	//note that the outline is consist of many coutours so the contour list is an array of an unsigned array
+	//the path commands are recorded first and all Bezier curves of the glyph are flattened in one batch by get()
 	struct Char3DInfo
 	{
+		enum CommandType { MOVE_TO, LINE_TO, CURVE_TO };
+		struct Command
+		{
+			CommandType type;
+			glm::vec2 pos;                       //the end point of the command
+			unsigned int curve;                  //index of the curve in the batch
+		};
+
 		Vec3Array vertices;                      //store the postions of glyph vertex
 		ElementArray current_indices;            //store the indices of coutour
 		std::vector<ElementArray> contour_list;  //contour's indices list
-		glm::vec3 previous;                      //the previous vertex of current vertex(use to sample Bezier)
-		unsigned int num_steps;                  //number of step to sample the Bezier
+		std::vector<Command> commands;           //the recorded path of the outline
+		BezierBatch curves;                      //the curves to flatten
+		std::vector<glm::vec2> samples;          //the flattened points of the curves
+		glm::vec2 previous;                      //the previous vertex of current vertex(use to sample Bezier)
+		float tolerance;                         //max distance between a Bezier and its line segments, in outline units(1/64 pixel)
+		unsigned int max_steps;                  //upper bound of the number of segments of one Bezier
 		float coord_scale;                       //freetype use the 1/64 pixel format means we shoule set this value to 1/64
 
-		Char3DInfo() : num_steps(10), coord_scale(1.0 / 64.0) {}
+		Char3DInfo(float tol = DefaultTolerance) : tolerance(tol), max_steps(64), coord_scale(1.0 / 64.0) {}
+
+		//preallocate the buffers for an outline of num_points points and num_contours contours
+		void reserve(unsigned int num_points, unsigned int num_contours)
+		{
+			vertices.reserve(num_points);
+			current_indices.reserve(num_points + 1);
+			contour_list.reserve(num_contours);
+			commands.reserve(num_points + num_contours);
+			curves.reserve(num_points);
+		}
 
 		void completeCurrentContour()
 		{
 			if (!vertices.empty() && !current_indices.empty())
-				contour_list.push_back(current_indices);
+			{
+				contour_list.emplace_back(current_indices.begin(), current_indices.end());
+			}
 			current_indices.clear();
 		}
-		//return the data to Glyph3D to do triangulation
+		//evaluate the samples of all recorded curves and replay the commands to build the contours
+		void flatten()
+		{
+			samples.resize(curves.num_samples);
+			if (curves.num_samples)
+				evaluateBezierBatch(curves, &samples[0]);
+
+			for (const Command &cmd : commands)
+			{
+				switch (cmd.type)
+				{
+				case MOVE_TO:
+					completeCurrentContour();
+					addVertex(cmd.pos);
+					break;
+				case LINE_TO:
+					addVertex(cmd.pos);
+					break;
+				case CURVE_TO:
+				{
+					//u = 0 is the previous vertex, and the last vertex is the end point itself
+					const glm::vec2 *p = &samples[0] + curves.first[cmd.curve];
+					for (unsigned int i = 1; i < curves.steps[cmd.curve]; ++i)
+						addVertex(*p++);
+					addVertex(cmd.pos);
+					break;
+				}
+				}
+			}
+
+			commands.clear();
+			curves.clear();
+		}
+		//return the data to Glyph3D to do triangulation, the buffers are moved to the glyph
 		Glyph3D get()
 		{
+			flatten();
 			completeCurrentContour();
-			return Glyph3D(vertices, contour_list);
+			return Glyph3D(std::move(vertices), std::move(contour_list));
 		}
 
-		void addVertex(glm::vec3 pos)
+		void addVertex(const glm::vec2 &p)
 		{
-			previous = pos;
-			pos *= coord_scale;
+			glm::vec3 pos(p.x * coord_scale, p.y * coord_scale, 0);
 			//no need to add the same vertex
 			if (!vertices.empty() && vertices.back() == pos)
 				return;
@@ -64,146 +141,64 @@ namespace FreeType
 		//move to a new contour
 		void moveTo(const glm::vec2 &pos)
 		{
-			completeCurrentContour();
-			addVertex(glm::vec3(pos.x, pos.y, 0));
+			commands.push_back(Command{ MOVE_TO, pos, 0 });
+			previous = pos;
 		}
 		//draw line segment
 		void lineTo(const glm::vec2 &pos)
 		{
-			addVertex(glm::vec3(pos.x, pos.y, 0));
+			commands.push_back(Command{ LINE_TO, pos, 0 });
+			previous = pos;
 		}
 		//draw conic Bezier
 		void conicTo(const glm::vec2 &control, const glm::vec2 &pos)
 		{
-			glm::vec3 p0 = previous;
-			glm::vec3 p1 = glm::vec3(control.x, control.y, 0);
-			glm::vec3 p2 = glm::vec3(pos.x, pos.y, 0);
-
-			GLfloat dt = 1.0 / num_steps;
-			GLfloat u = 0;
-			for (unsigned int i = 0; i <= num_steps; ++i)
-			{
-				GLfloat w = 1;
-				GLfloat bs = 1.0 / ((1 - u)*(1 - u) + 2 * (1 - u)*u*w + u*u);
-				glm::vec3 p = (p0*((1 - u)*(1 - u)) + p1*(2 * (1 - u)*u*w) + p2*(u*u)) * bs;
-				addVertex(p);
-
-				u += dt;
-			}
+			//the second derivative of a conic Bezier is the constant 2(p0 - 2p1 + p2)
+			unsigned int steps = flatteningSteps(2 * glm::length(previous - control * 2.0f + pos), tolerance, max_steps);
+			unsigned int curve = curves.addConic(previous, control, pos, steps);
+			commands.push_back(Command{ CURVE_TO, pos, curve });
+			previous = pos;
 		}
 		//draw cubic Bezier
 		void cubicTo(const glm::vec2 &control1, const glm::vec2 &control2, const glm::vec2 &pos)
 		{
-			glm::vec3 p0 = previous;
-			glm::vec3 p1 = glm::vec3(control1.x, control1.y, 0);
-			glm::vec3 p2 = glm::vec3(control2.x, control2.y, 0);
-			glm::vec3 p3 = glm::vec3(pos.x, pos.y, 0);
-
-			GLfloat cx = 3 * (p1.x - p0.x);
-			GLfloat bx = 3 * (p2.x - p1.x) - cx;
-			GLfloat ax = p3.x - p0.x - cx - bx;
-			GLfloat cy = 3 * (p1.y - p0.y);
-			GLfloat by = 3 * (p2.y - p1.y) - cy;
-			GLfloat ay = p3.y - p0.y - cy - by;
-
-			GLfloat dt = 1.0 / num_steps;
-			GLfloat u = 0;
-			for (unsigned int i = 0; i <= num_steps; ++i)
-			{
-				glm::vec3 p = glm::vec3(ax*u*u*u + bx*u*u + cx*u + p0.x, ay*u*u*u + by*u*u + cy*u + p0.y, 0);
-				addVertex(p);
-
-				u += dt;
-			}
+			//the second derivative of a cubic Bezier is a linear blend of 6(p0 - 2p1 + p2) and 6(p1 - 2p2 + p3)
+			float dd = 6 * std::max(glm::length(previous - control1 * 2.0f + control2), glm::length(control1 - control2 * 2.0f + pos));
+			unsigned int steps = flatteningSteps(dd, tolerance, max_steps);
+			unsigned int curve = curves.addCubic(previous, control1, control2, pos, steps);
+			commands.push_back(Command{ CURVE_TO, pos, curve });
+			previous = pos;
 		}
 	};  //end of Char3DInfo
 
-	//callback function use to decompose outline
-	//return 0 means successful
-	int moveTo(const FT_Vector* to, void* user)
-	{
-		Char3DInfo* char3d = (Char3DInfo*)user;
-		char3d->moveTo(glm::vec2(to->x, to->y));
-		return 0;
-	}
-	int lineTo(const FT_Vector* to, void* user)
-	{
-		Char3DInfo* char3d = (Char3DInfo*)user;
-		char3d->lineTo(glm::vec2(to->x, to->y));
-		return 0;
-	}
-	int conicTo(const FT_Vector* control, const FT_Vector* to, void* user)
-	{
-		Char3DInfo* char3d = (Char3DInfo*)user;
-		char3d->conicTo(glm::vec2(control->x, control->y), glm::vec2(to->x, to->y));
-		return 0;
-	}
-	int cubicTo(const FT_Vector* control1, const FT_Vector* control2, const FT_Vector* to, void* user)
-	{
-		Char3DInfo* char3d = (Char3DInfo*)user;
-		char3d->cubicTo(
-			glm::vec2(control1->x, control1->y),
-			glm::vec2(control2->x, control2->y),
-			glm::vec2(to->x, to->y));
-		return 0;
-	}
+	//walk the points, tags and contours arrays of the outline and write the contours straight into char3d,
+	//the result is identical to FT_Outline_Decompose with shift = delta = 0
+	//return false if the outline is invalid
+	bool decomposeOutline(const FT_Outline &outline, Char3DInfo &char3d);
 }   //close namespace FreeType
 
 
+//the outline of one glyph, loaded by glyph index from a face of FontRegistry
 class FreeTypeFont
 {
 public:
-	FreeTypeFont(wchar_t code, GLchar *font_file);
-	~FreeTypeFont()
-	{
-		FT_Done_Face(face);
-		FT_Done_FreeType(ft);
-	}
+	//tolerance is the max distance between the Bezier curves and their flattened line segments, in 1/64 pixel
+	FreeTypeFont(FontFace *font_face, FT_UInt glyph_index, float tolerance = FreeType::DefaultTolerance);
+	~FreeTypeFont();
+
+	FreeTypeFont(const FreeTypeFont&) = delete;
+	FreeTypeFont& operator=(const FreeTypeFont&) = delete;
+
 	Glyph3D getGlyph3D();
 	GLuint advanceX() const { return AdvanceX; }
+	//false if the glyph can't be loaded from the face
+	bool isValid() const { return glyph != nullptr; }
+	FT_UInt glyphIndex() const { return glyph_index; }
 
 private:
-	wchar_t charcode;
-	FT_Library ft;
-	FT_Face face;
+	FT_UInt glyph_index;
+	//the glyph slot of a face is overwritten by every load, so we keep our own copy of the outline
+	FT_Glyph glyph;
 	GLuint AdvanceX;
 	FreeType::Char3DInfo char3d;
-};
-
-FreeTypeFont::FreeTypeFont(wchar_t code, char *font_file)
-{
-	if (FT_Init_FreeType(&ft))
-		std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-	if (FT_New_Face(ft, font_file, 0, &face))
-		std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
-	FT_Set_Pixel_Sizes(face, 0, 24);
-
-	charcode = code;
-	//load character face
-	FT_Error error = FT_Load_Char(face, charcode, FT_LOAD_DEFAULT);
-	if (error)
-		std::cout << "FT_Load_Char(...) error 0x" << std::hex << error << std::dec << std::endl;
-	if (face->glyph->format != FT_GLYPH_FORMAT_OUTLINE)
-		std::cout << "FreeTypeFont3D::getGlyph : not a vector font" << std::endl;
-
-	AdvanceX = (face->glyph->advance.x) >> 6;
-}
-
-Glyph3D FreeTypeFont::getGlyph3D()
-{
-	FT_Outline outline = face->glyph->outline;
-	FT_Outline_Funcs funcs;
-	funcs.conic_to = (FT_Outline_ConicToFunc)&FreeType::conicTo;
-	funcs.line_to  = (FT_Outline_LineToFunc )&FreeType::lineTo;
-	funcs.cubic_to = (FT_Outline_CubicToFunc)&FreeType::cubicTo;
-	funcs.move_to  = (FT_Outline_MoveToFunc )&FreeType::moveTo;
-	funcs.shift = 0;
-	funcs.delta = 0;
-
-	//register the callback function
-	FT_Error _error = FT_Outline_Decompose(&outline, &funcs, &char3d);
-	if (_error)
-		std::cout << "FreeTypeFont3D::getGlyph : - outline decompose failed ..." << std::endl;
-	
-	return char3d.get();
-}
\ No newline at end of file
+};
\ No newline at end of file
@@ -1,22 +1,54 @@
 #pragma once
 
-#include "TriangleIndexFunctor.h"
-
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <cfloat>
 
+#include <glad\glad.h>
 #include <glm\glm.hpp>
 
 using ElementArray = std::vector<unsigned int>;
 using Vec3Array = std::vector<glm::vec3>;
 
+//an axis aligned bounding box, a default box is empty
+struct BoundingBox
+{
+	glm::vec3 min;
+	glm::vec3 max;
+
+	BoundingBox() : min(FLT_MAX), max(-FLT_MAX) {}
+	BoundingBox(const glm::vec3 &bmin, const glm::vec3 &bmax) : min(bmin), max(bmax) {}
+
+	bool empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+	glm::vec3 center() const { return (min + max) * 0.5f; }
+	void expand(const glm::vec3 &p) { min = glm::min(min, p); max = glm::max(max, p); }
+	void expand(const BoundingBox &b) { min = glm::min(min, b.min); max = glm::max(max, b.max); }
+
+	//the box of the transformed box, it holds the 8 transformed corners
+	BoundingBox transform(const glm::mat4 &m) const
+	{
+		if (empty()) return *this;
+		//every column of the matrix moves the box by its smallest and largest product with the extent of that axis
+		glm::vec3 bmin(m[3]), bmax(m[3]);
+		for (int k = 0; k < 3; ++k)
+		{
+			glm::vec3 a = glm::vec3(m[k]) * min[k], b = glm::vec3(m[k]) * max[k];
+			bmin += glm::min(a, b);
+			bmax += glm::max(a, b);
+		}
+		return BoundingBox(bmin, bmax);
+	}
+};
+
 class Glyph3D
 {
 public:
 	Glyph3D() = default;
 	Glyph3D(const Vec3Array& va, const std::vector<ElementArray>& el) :
 		_vertices(va), _elements(el) {}
+	Glyph3D(Vec3Array&& va, std::vector<ElementArray>&& el) :
+		_vertices(std::move(va)), _elements(std::move(el)) {}
 
 	//the positions and contours's indices used to do triangulation
 	Vec3Array* getVertexPos() { return &_vertices; }
@@ -26,11 +58,6 @@ public:
 	//remove from index b, remove numToRemove's contours
 	bool removeElements(unsigned int b, unsigned int numToRemove);
 
-	void addNormalArray(const Vec3Array &normals)
-	{
-		_normals.push_back(normals);
-	}
-
 	//add indices
 	void addPrimitiveSet(ElementArray* element) { _elements.push_back(*element); }
 
@@ -38,12 +65,9 @@ public:
 	void addMode(GLenum mode) { _modeList.push_back(mode); }
 	void clearModeList() { _modeList.clear(); }
 
-	//generate the GL_TRIANGLES indices
-	void accept(PrimitiveIndexFunctor& functor) const;
-
 	//the final data that transmited to opengl
-	//three face's date(front face, wall face and back face) merge to one mesh
-	Vec3Array getNormalArray() const;
+	//three face's date(front face, wall face and back face) merge to one indexed mesh, a normal per vertex
+	const Vec3Array& getNormalArray() const { return _normals; }
 	ElementArray getIndices() const;
 
 	//output final data to txt file
@@ -51,32 +75,11 @@ public:
 
 public:
 	Vec3Array _vertices;            //positions
-	std::vector<Vec3Array> _normals;           
+	Vec3Array _normals;             //normals of the vertices after computeGlyphGeometry
 	std::vector<ElementArray> _elements;       
 
-	//because the gluTess not only generate GL_TRIANGLES mode but also GL_TRIANGLE_FAN, GL_TRIANGLE_STRIP;
-	//but we will unify them to GL_TRIANGLES, so we use this vector to store the original data that from gluTess
-	//and process them by our PrimitiveIndexFuntor
+	//the primitive mode of every element array, the contours have none until they are tessellated,
+	//then it is always GL_TRIANGLES: the fans and strips from gluTess are unrolled in its vertex callback
 	std::vector<GLenum> _modeList;
 };
 
-
-struct CollectTriangleIndicesFunctor
-{
-	CollectTriangleIndicesFunctor() = default;
-
-	using Indices = std::vector<unsigned int>;
-	Indices _indices;
-
-	void operator() (unsigned int p1, unsigned int p2, unsigned int p3)
-	{
-		if (p1 == p2 || p2 == p3 || p1 == p3)
-		{
-			return;
-		}
-
-		_indices.push_back(p1);
-		_indices.push_back(p3);
-		_indices.push_back(p2);
-	}
-};
\ No newline at end of file
@@ -0,0 +1,89 @@
+//build the meshes of many glyphs on all cores
+//every worker thread owns a FreeType face(over the shared mapping of the font file) and a Tessellator,
+//the glyphs of a build are split to chunks in a deque per worker, a worker whose deque is empty steals chunks from the others
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "FontRegistry.h"
+#include "GlyphMeshCache.h"
+#include "MeshOptimizer.h"
+#include "Tessellator.h"
+
+class GlyphBuilder
+{
+public:
+	//num_threads is the number of worker threads, 0 means all cores
+	explicit GlyphBuilder(FontRegistry &fonts, unsigned int num_threads = 0);
+	~GlyphBuilder();
+
+	GlyphBuilder(const GlyphBuilder&) = delete;
+	GlyphBuilder& operator=(const GlyphBuilder&) = delete;
+
+	//build the meshes of the characters, the result has the order of the characters
+	//a glyph is built once even if many characters use it, the meshes in the cache are not built again and the built ones are inserted
+	//the mesh of a glyph that can't be built is nullptr
+	std::vector<std::shared_ptr<const GlyphMesh>> build(FontFace *font_face, const std::vector<FT_ULong> &charcodes,
+		float tolerance, float depth, float crease_angle = DefaultCreaseAngle, GlyphMeshCache *cache = nullptr);
+	std::vector<std::shared_ptr<const GlyphMesh>> build(FontFace *font_face, const std::wstring &text,
+		float tolerance, float depth, float crease_angle = DefaultCreaseAngle, GlyphMeshCache *cache = nullptr);
+
+	unsigned int getThreadsNum() const { return _workers.size(); }
+
+	//glyphs built and chunks stolen by every worker in the last build, and the vertex cache of the built meshes
+	void printStats(std::ostream &os) const;
+
+private:
+	struct Chunk
+	{
+		unsigned int begin, end;
+	};
+
+	struct Job
+	{
+		FontFace *fontFace;
+		float tolerance;
+		float depth;
+		float creaseAngle;
+		GlyphMeshCache *cache;
+		std::vector<FT_UInt> glyphs;
+		std::vector<std::shared_ptr<const GlyphMesh>> meshes;
+		unsigned int activeWorkers;
+	};
+
+	struct Worker
+	{
+		std::thread thread;
+		std::mutex mutex;               //guards the chunks
+		std::deque<Chunk> chunks;       //the owner pops from the front, thieves steal from the back
+		Tessellator tessellator;
+		std::map<unsigned int, FontFace*> faces;   //FontFace::id -> the face of this worker
+
+		unsigned int built = 0;
+		unsigned int stolen = 0;
+		VertexCacheStats cacheBefore, cacheAfter;
+	};
+
+	void run(Worker *worker);
+	bool popChunk(Worker *worker, Chunk &chunk);
+	bool stealChunk(Worker *worker, Chunk &chunk);
+	void buildGlyph(Worker *worker, Job &job, unsigned int i);
+
+	FontRegistry &_fonts;
+	std::vector<Worker*> _workers;
+
+	std::mutex _mutex;
+	std::condition_variable _wake;   //a new job is posted or the builder is destroyed
+	std::condition_variable _done;   //every worker left the job
+	Job *_job;
+	unsigned int _generation;
+	bool _quit;
+};
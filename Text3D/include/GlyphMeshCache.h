@@ -0,0 +1,98 @@
+//an in-process LRU cache of finished 3D glyph meshes
+//a glyph is built by FreeType, tessellation and computeGlyphGeometry only at the first time it is used,
+//repeated characters of a string and of other text objects share the same mesh
+#pragma once
+
+#include <iostream>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+#include "FontRegistry.h"
+#include "Glyph3D.h"
+#include "MeshOptimizer.h"
+#include "Tessellator.h"
+
+//the extruded mesh of a glyph and the data needed to lay it out
+struct GlyphMesh
+{
+	Glyph3D glyph;        //the output of computeGlyphGeometry
+	GLuint advanceX;
+
+	//the bytes used by the mesh data
+	size_t memorySize() const;
+};
+
+struct GlyphMeshKey
+{
+	unsigned int fontId;   //FontFace::id
+	FT_UInt glyphIndex;
+	float tolerance;       //Bezier flattening tolerance
+	float depth;           //extrusion depth
+	float creaseAngle;     //wall smoothing angle in degrees
+
+	bool operator==(const GlyphMeshKey &rhs) const
+	{
+		return fontId == rhs.fontId && glyphIndex == rhs.glyphIndex &&
+			tolerance == rhs.tolerance && depth == rhs.depth && creaseAngle == rhs.creaseAngle;
+	}
+};
+
+struct GlyphMeshKeyHash
+{
+	size_t operator()(const GlyphMeshKey &key) const;
+};
+
+class GlyphMeshCache
+{
+public:
+	//budget is the max bytes of mesh data kept in the cache
+	explicit GlyphMeshCache(size_t budget = 64 * 1024 * 1024);
+
+	GlyphMeshCache(const GlyphMeshCache&) = delete;
+	GlyphMeshCache& operator=(const GlyphMeshCache&) = delete;
+
+	//return the mesh of the glyph, it is built and inserted at the first time
+	//return nullptr if the glyph can't be built
+	std::shared_ptr<const GlyphMesh> get(FontFace *font_face, FT_UInt glyph_index, float tolerance, float depth,
+		float crease_angle = DefaultCreaseAngle);
+
+	//return the cached mesh or nullptr, a found mesh becomes the most recently used one
+	std::shared_ptr<const GlyphMesh> find(const GlyphMeshKey &key);
+	//insert a mesh, the least recently used meshes are evicted until the cache fits the budget
+	void insert(const GlyphMeshKey &key, const std::shared_ptr<const GlyphMesh> &mesh);
+
+	void setBudget(size_t budget);
+	size_t getBudget() const { return _budget; }
+	size_t getMemoryUsage() const { return _memory; }
+	unsigned int getMeshesNum() const { return _index.size(); }
+	void clear();
+
+	//counters since the cache was created or since resetCounters
+	unsigned long long getHits() const { return _hits; }
+	unsigned long long getMisses() const { return _misses; }
+	unsigned long long getEvictions() const { return _evictions; }
+	void resetCounters();
+
+	void printStats(std::ostream &os) const;
+
+private:
+	void evict();
+
+	using Entry = std::pair<GlyphMeshKey, std::shared_ptr<const GlyphMesh>>;
+	using LRUList = std::list<Entry>;
+
+	LRUList _lru;    //the most recently used mesh is at the front
+	std::unordered_map<GlyphMeshKey, LRUList::iterator, GlyphMeshKeyHash> _index;
+
+	size_t _budget;
+	size_t _memory;
+
+	unsigned long long _hits;
+	unsigned long long _misses;
+	unsigned long long _evictions;
+	VertexCacheStats _cacheBefore, _cacheAfter;   //the simulated vertex cache of the meshes built by get
+
+	mutable std::mutex _mutex;
+};
@@ -0,0 +1,152 @@
+//a versioned binary file of baked glyph meshes
+//the file is memory mapped and its vertex and index data are uploaded to opengl as they are, without any parsing
+//
+//layout(little endian, every section is 16 bytes aligned):
+//    GlyphPackHeader
+//    GlyphPackEntry[glyphCount]        sorted by glyph index, the lookup table of the glyphs
+//    GlyphPackCharEntry[charCount]     sorted by character code
+//    GlyphPackVertex[vertexCount]      the quantized vertices of all glyphs, decoded by the bounds of their glyph
+//    GLuint[indexCount]                the GL_TRIANGLES indices of all glyphs, relative to the first vertex of their glyph
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+#include <glad\glad.h>
+#include <glm\glm.hpp>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "MappedFile.h"
+#include "VertexQuantizer.h"
+
+struct GlyphMesh;
+
+const char GlyphPackMagic[4] = { 'T', '3', 'G', 'P' };
+const unsigned int GlyphPackVersion = 3;
+
+struct GlyphPackHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned int headerSize;         //sizeof(GlyphPackHeader)
+	unsigned int vertexStride;       //sizeof(GlyphPackVertex)
+
+	unsigned int glyphCount;
+	unsigned int charCount;
+	unsigned int vertexCount;
+	unsigned int indexCount;
+
+	unsigned int glyphTableOffset;   //byte offsets from the beginning of the file
+	unsigned int charTableOffset;
+	unsigned int vertexDataOffset;
+	unsigned int indexDataOffset;
+
+	unsigned int fileSize;
+	unsigned int pixelSize;          //the pixel size of the face the glyphs baked from
+	float tolerance;                 //Bezier flattening tolerance
+	float depth;                     //extrusion depth
+
+	float creaseAngle;               //wall smoothing angle in degrees
+	unsigned int reserved[3];
+};
+
+struct GlyphPackEntry
+{
+	unsigned int glyphIndex;
+	int advanceX;
+	float boundsMin[3];              //the quantization bounds of the vertices
+	float boundsMax[3];
+	unsigned int firstVertex;
+	unsigned int vertexCount;
+	unsigned int firstIndex;
+	unsigned int indexCount;
+};
+
+struct GlyphPackCharEntry
+{
+	unsigned int charcode;
+	unsigned int glyphIndex;
+};
+
+//the vertices are stored as they are uploaded to opengl
+using GlyphPackVertex = QuantizedVertex;
+
+static_assert(sizeof(GlyphPackHeader) == 80, "GlyphPackHeader must be 80 bytes");
+static_assert(sizeof(GlyphPackEntry) == 48, "GlyphPackEntry must be 48 bytes");
+static_assert(sizeof(GlyphPackVertex) == 12, "GlyphPackVertex must be 12 bytes");
+
+//a glyph converted to the pack layout, its entry's offsets are set when it is added to a writer
+struct GlyphPackGlyph
+{
+	GlyphPackEntry entry;
+	std::vector<GlyphPackVertex> vertices;
+	std::vector<GLuint> indices;
+};
+
+//collect baked glyphs and write them to a glyph pack file
+class GlyphPackWriter
+{
+public:
+	GlyphPackWriter(unsigned int pixel_size, float tolerance, float depth, float crease_angle);
+
+	//convert a mesh to the pack layout, it doesn't touch the writer and can be called by many threads at the same time
+	static GlyphPackGlyph convert(FT_UInt glyph_index, const GlyphMesh &mesh);
+
+	//add the mesh of a glyph, a glyph that has been added before is only mapped to the new charcode
+	void addGlyph(FT_ULong charcode, FT_UInt glyph_index, const GlyphMesh &mesh);
+	void addGlyph(FT_ULong charcode, const GlyphPackGlyph &glyph);
+	//map a charcode to a glyph added before
+	void addChar(FT_ULong charcode, FT_UInt glyph_index);
+
+	unsigned int getGlyphsNum() const { return _entries.size(); }
+
+	bool write(const std::string &path);
+
+private:
+	GlyphPackHeader _header;
+	std::vector<GlyphPackEntry> _entries;
+	std::unordered_set<FT_UInt> _glyphs;
+	std::vector<GlyphPackCharEntry> _chars;
+	std::vector<GlyphPackVertex> _vertices;
+	std::vector<GLuint> _indices;
+};
+
+//a glyph pack mapped to memory
+class GlyphPack
+{
+public:
+	GlyphPack() : _header(nullptr), _entries(nullptr), _chars(nullptr), _vertices(nullptr), _indices(nullptr) {}
+
+	//map and validate the file, return false if it is not a valid glyph pack of this version
+	bool open(const std::string &path);
+	void close();
+
+	bool isOpen() const { return _header != nullptr; }
+	const GlyphPackHeader& header() const { return *_header; }
+
+	//the entry of a glyph, nullptr if the glyph is not in the pack
+	const GlyphPackEntry* findGlyph(FT_UInt glyph_index) const;
+	//the glyph index of a charcode, 0 if the charcode is not in the pack
+	FT_UInt glyphIndex(FT_ULong charcode) const;
+
+	const GlyphPackVertex* vertices(const GlyphPackEntry &entry) const { return _vertices + entry.firstVertex; }
+	const GLuint* indices(const GlyphPackEntry &entry) const { return _indices + entry.firstIndex; }
+	//the bounds to decode the vertices of a glyph
+	static QuantizationBounds bounds(const GlyphPackEntry &entry);
+
+	const GlyphPackEntry* entries() const { return _entries; }
+
+private:
+	bool validate() const;
+
+	MappedFile _file;
+	const GlyphPackHeader *_header;
+	const GlyphPackEntry *_entries;
+	const GlyphPackCharEntry *_chars;
+	const GlyphPackVertex *_vertices;
+	const GLuint *_indices;
+};
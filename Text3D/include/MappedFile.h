@@ -0,0 +1,38 @@
+//a read-only memory mapping of a whole file
+//the pages are loaded by the system on demand and shared by everyone who reads the mapping
+#pragma once
+
+#include <iostream>
+#include <string>
+
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	//map the file, return false if the file can't be opened or mapped
+	bool open(const std::string &path);
+	void close();
+
+	bool isOpen() const { return _data != nullptr; }
+	const unsigned char* data() const { return _data; }
+	size_t size() const { return _size; }
+
+	//the number of bytes of the mapping that are currently resident in physical memory
+	size_t residentBytes() const;
+
+private:
+	const unsigned char *_data;
+	size_t _size;
+
+#ifdef _WIN32
+	void *_file;
+	void *_mapping;
+#else
+	int _fd;
+#endif
+};
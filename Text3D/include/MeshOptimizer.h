@@ -0,0 +1,59 @@
+//reordering of indexed triangle meshes for the GPU
+//the triangles are reordered for the post-transform vertex cache, by Tom Forsyth's linear-speed algorithm or by Tipsify,
+//then the vertices are renumbered in the order they are first used, so the vertex fetch walks the buffer forward
+//the effect is measured by a software FIFO cache, so it can be checked without a GPU
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include "Glyph3D.h"
+
+//the size of the FIFO cache used to measure index buffers, a typical post-transform cache
+const unsigned int VertexCacheSize = 16;
+
+//the result of running an index buffer through the simulated cache
+//ACMR is the transformed vertices per triangle(0.5 is the best for big regular meshes, 3 is the worst),
+//ATVR is the transformed vertices per used vertex(1 is the best)
+struct VertexCacheStats
+{
+	unsigned long long triangles = 0;
+	unsigned long long vertices = 0;     //the vertices used by the triangles
+	unsigned long long transforms = 0;   //the cache misses
+
+	double acmr() const { return triangles ? double(transforms) / triangles : 0.0; }
+	double atvr() const { return vertices ? double(transforms) / vertices : 0.0; }
+
+	void add(const VertexCacheStats &stats)
+	{
+		triangles += stats.triangles;
+		vertices += stats.vertices;
+		transforms += stats.transforms;
+	}
+};
+
+//simulate a FIFO cache of cache_size vertices over the GL_TRIANGLES indices
+VertexCacheStats analyzeVertexCache(const ElementArray &indices, unsigned int num_vertices, unsigned int cache_size = VertexCacheSize);
+
+//FORSYTH gives the best order, TIPSIFY is about twice as fast and a little worse
+enum VertexCacheMethod { FORSYTH, TIPSIFY };
+
+//reorder the triangles of [first, last) for the vertex cache by Forsyth's scores, the triangles themselves are not changed
+void optimizeVertexCache(unsigned int *first, unsigned int *last);
+void optimizeVertexCache(ElementArray &indices);
+
+//reorder the triangles by Tipsify(Sander et al.), which fans around the vertices and targets a FIFO cache of cache_size
+void optimizeVertexCacheFifo(unsigned int *first, unsigned int *last, unsigned int cache_size = VertexCacheSize);
+void optimizeVertexCacheFifo(ElementArray &indices, unsigned int cache_size = VertexCacheSize);
+
+//renumber the vertices in the order the indices first use them, the indices are rewritten
+//return the new index of every old vertex, the vertices no index uses are moved to the end
+ElementArray optimizeVertexFetch(ElementArray &indices, unsigned int num_vertices);
+
+//optimize the output of computeGlyphGeometry: the triangles of every face(front, back and each wall) are reordered,
+//then the vertices and normals of the glyph are renumbered, the faces stay in their order
+//the simulated cache before and after the optimization is added to the stats if they are given
+void optimizeGlyphMesh(Glyph3D &glyph, VertexCacheMethod method, VertexCacheStats *before = nullptr, VertexCacheStats *after = nullptr);
+
+//output the ACMR and ATVR before and after
+void printVertexCacheStats(std::ostream &os, const char *name, const VertexCacheStats &before, const VertexCacheStats &after);
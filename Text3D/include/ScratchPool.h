@@ -0,0 +1,42 @@
+//a pool of scratch objects used while one glyph is triangulated
+//objects are handed out from fixed size blocks and never freed one by one,
+//reset() makes every object available again for the next glyph, so a warmed up pool doesn't touch the heap at all
+#pragma once
+
+#include <vector>
+
+template <typename T>
+class ScratchPool
+{
+public:
+	explicit ScratchPool(size_t block_size = 256) : _blockSize(block_size), _used(0) {}
+	~ScratchPool()
+	{
+		for (auto block : _blocks)
+			delete[] block;
+	}
+
+	ScratchPool(const ScratchPool&) = delete;
+	ScratchPool& operator=(const ScratchPool&) = delete;
+
+	//return an unused object, it keeps the state of its last use(e.g. the capacity of its vectors)
+	//the address never changes until the pool is destroyed
+	T* next()
+	{
+		size_t block = _used / _blockSize;
+		if (block == _blocks.size())
+			_blocks.push_back(new T[_blockSize]);
+		return &_blocks[block][_used++ % _blockSize];
+	}
+
+	//all objects become unused, the memory is kept
+	void reset() { _used = 0; }
+
+	size_t size() const { return _used; }
+	size_t capacity() const { return _blocks.size() * _blockSize; }
+
+private:
+	std::vector<T*> _blocks;
+	size_t _blockSize;
+	size_t _used;
+};
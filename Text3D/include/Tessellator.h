@@ -1,13 +1,15 @@
 #pragma once
 
 #include <iostream>
-#include <map>
+#include <functional>
 
 #include <glad\glad.h>
 #include <GL\GLU.H>
 #include <glm\glm.hpp>
 
 #include "Glyph3D.h"
+#include "ScratchPool.h"
+#include "Triangulator.h"
 
 #define CALLBACK __stdcall
 typedef void (CALLBACK * GLU_TESS_CALLBACK)();
@@ -18,18 +20,13 @@ public:
 	Tessellator();
 	~Tessellator();
 
-	void retessellatePolygons(Glyph3D &geom);
-
-	//store the data which from glu triangulation
-	struct Prim
-	{
-		Prim(GLenum mode) :_mode(mode) {}
-
-		using VecList = std::vector<glm::vec3*>;
+	//triangulate the contours of the glyph by Triangulator, the contours it can't handle are tessellated by GLU
+	//both give the glyph one GL_TRIANGLES primitive, return false if GLU fails too, a tessellator can be used for any number of glyphs
+	bool tessellate(Glyph3D &geom);
 
-		GLenum  _mode;
-		VecList _vertices;
-	};
+	//tessellate the contours by GLU, the glyph gets one GL_TRIANGLES primitive
+	//the fans and strips from GLU are unrolled to triangles in the vertex callback
+	void retessellatePolygons(Glyph3D &geom);
 
 	void beginTessellation();
 
@@ -41,24 +38,33 @@ public:
 
 	void endTessellation();
 
-	using PrimList = std::vector<Prim*>;
+	//the triangles of the last GLU tessellation, three indices per triangle
+	const ElementArray& getTriangles() const { return _triangles; }
 
-	PrimList& getPrimList() { return _primList; }
+	//the GLU error of the last tessellation, 0 means no error
+	GLenum getErrorCode() const { return _errorCode; }
 
 	void reset();
 
 private:
-	void collectTessellation(Glyph3D &geom, unsigned int originalIndex);
+	void collectTessellation(Glyph3D &geom);
 
-	using VertexPtrToIndexMap = std::map<glm::vec3*, unsigned int>;
 	void addContour(ElementArray* primitive, Vec3Array* vertices);
-	void handleNewVertices(Glyph3D& geom, VertexPtrToIndexMap &vertexPtrToIndexMap);
+	void handleNewVertices(Glyph3D& geom);
+	//the index in the glyph of a vertex handed out by GLU, in constant time
+	unsigned int vertexIndex(const glm::vec3* vertex) const;
 
 	void begin(GLenum mode);
 	void vertex(glm::vec3* vertex);
 	void combine(glm::vec3* vertex, void* vertex_data[4], GLfloat weight[4]);
 	void end();
 	void error(GLenum errorCode);
+	void addTriangle(unsigned int p1, unsigned int p2, unsigned int p3)
+	{
+		_triangles.push_back(p1);
+		_triangles.push_back(p2);
+		_triangles.push_back(p3);
+	}
 
 	static void CALLBACK beginCallback(GLenum which, void* userData);
 	static void CALLBACK vertexCallback(GLvoid *data, void* userData);
@@ -73,6 +79,13 @@ private:
 		double _v[3];
 	};
 
+	// a vertex created by GLU at an intersection, it carries the index it will have in the glyph
+	struct CombineVertex
+	{
+		glm::vec3    _pos;     // the first member, GLU hands out the address of the position
+		unsigned int _index;
+	};
+
 	struct NewVertex
 	{
 
@@ -130,22 +143,34 @@ private:
 	};
 
 	using NewVertexList = std::vector<NewVertex>;
-	using Vec3dList = std::vector<Vec3d*>;
 
 	GLUtesselator*  _tobj;
 
-	PrimList        _primList;
-	Vec3dList       _coordData;
+	ElementArray    _triangles;
+	GLenum          _primMode;       // the primitive being emitted by GLU
+	unsigned int    _primCount;      // its vertices so far
+	unsigned int    _primIndices[2]; // the earlier vertices the next triangle is made of
 	NewVertexList   _newVertexList;
 	GLenum          _errorCode;
 
-	unsigned int _numberVerts;
+	//the scratch memory of a glyph comes from these pools and is reused by the next glyph
+	ScratchPool<Vec3d>         _coordData;
+	ScratchPool<CombineVertex> _combineVertices;
 
-	std::vector<ElementArray> _Contours;
+	Triangulator _triangulator;
 
-	unsigned int _index;
+	unsigned int _numberVerts;
+	const glm::vec3* _vertexBase;      // the first vertex of the glyph being tessellated
 
-	unsigned int _extraPrimitives;
+	std::vector<ElementArray> _Contours;
 };
 
-void computeGlyphGeometry(Glyph3D &glyph, float width);
\ No newline at end of file
+//the wall normals of two adjacent contour segments are averaged if the angle between them(in degrees) is below the crease angle
+//0 gives every wall quad its own flat normal
+const float DefaultCreaseAngle = 30.0f;
+
+//extrude the glyph outline to a mesh of front, back and wall faces
+//return false if the outline can't be tessellated, a glyph without outline is not a failure
+bool computeGlyphGeometry(Glyph3D &glyph, float width, float crease_angle = DefaultCreaseAngle);
+//the same, but the scratch memory of the tessellator is reused, a thread building many glyphs should keep its own tessellator
+bool computeGlyphGeometry(Glyph3D &glyph, float width, Tessellator &ts, float crease_angle = DefaultCreaseAngle);
\ No newline at end of file
@@ -0,0 +1,110 @@
+//triangulation of glyph contours without GLU
+//the contours are filled by the positive winding rule like the GLU tessellator does:
+//the contours with the dominant orientation are outer contours, the others are holes of the smallest outer contour containing them,
+//every outer contour is bridged to its holes and cut to triangles by ear clipping(the algorithm of mapbox earcut)
+//
+//the ear clipping is ported from mapbox earcut(https://github.com/mapbox/earcut), which is under the ISC license:
+//
+//ISC License
+//
+//Copyright (c) 2016, Mapbox
+//
+//Permission to use, copy, modify, and/or distribute this software for any purpose
+//with or without fee is hereby granted, provided that the above copyright notice
+//and this permission notice appear in all copies.
+//
+//THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD TO
+//THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+//IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+//CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA
+//OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION,
+//ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+#pragma once
+
+#include <vector>
+
+#include <glad\glad.h>
+#include <glm\glm.hpp>
+
+#include "Glyph3D.h"
+#include "ScratchPool.h"
+
+class Triangulator
+{
+public:
+	Triangulator() = default;
+
+	Triangulator(const Triangulator&) = delete;
+	Triangulator& operator=(const Triangulator&) = delete;
+
+	//replace the contours of the glyph with GL_TRIANGLES indices, no vertex is added
+	//the triangles have the same orientation as the ones from GLU
+	//return false and leave the glyph untouched if the contours can't be triangulated exactly(e.g. self-intersecting contours),
+	//such glyphs should be tessellated by GLU
+	bool triangulate(Glyph3D &glyph);
+
+private:
+	struct Node
+	{
+		unsigned int i;      //vertex index
+		double x, y;
+		Node *prev, *next;   //the polygon ring
+		Node *prevZ, *nextZ; //the ring sorted by z-order
+		unsigned int z;
+		bool steiner;
+	};
+
+	struct Ring
+	{
+		unsigned int contour;
+		unsigned int size;   //without the closing index
+		double area;         //signed area
+		glm::vec2 minPos, maxPos;
+		int parent;          //the outer ring of a hole
+	};
+
+	bool containsPoint(const Ring &ring, const glm::vec3 &p) const;
+
+	Node* linkedList(const Ring &ring, bool ccw);
+	Node* newNode(unsigned int i, double x, double y);
+	Node* insertNode(unsigned int i, Node *last);
+	static void removeNode(Node *p);
+	Node* filterPoints(Node *start, Node *end = nullptr);
+	Node* splitPolygon(Node *a, Node *b);
+
+	Node* eliminateHoles(const std::vector<const Ring*> &holes, Node *outer);
+	Node* findHoleBridge(Node *hole, Node *outer);
+
+	void earcutLinked(Node *ear, int pass);
+	bool isEar(Node *ear) const;
+	bool isEarHashed(Node *ear) const;
+	Node* cureLocalIntersections(Node *start);
+	void splitEarcut(Node *start);
+
+	void indexCurve(Node *start);
+	static Node* sortLinked(Node *list);
+	unsigned int zOrder(double x, double y) const;
+
+	static double area(const Node *p, const Node *q, const Node *r);
+	static bool equals(const Node *p, const Node *q) { return p->x == q->x && p->y == q->y; }
+	static bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py);
+	static bool intersects(const Node *p1, const Node *q1, const Node *p2, const Node *q2);
+	static bool intersectsPolygon(const Node *a, const Node *b);
+	static bool locallyInside(const Node *a, const Node *b);
+	static bool middleInside(const Node *a, const Node *b);
+	static bool isValidDiagonal(const Node *a, const Node *b);
+	static bool sectorContainsSector(const Node *m, const Node *p);
+
+	const Vec3Array *_vertices = nullptr;
+	const std::vector<ElementArray> *_contours = nullptr;
+
+	//the scratch memory is kept for the next glyph
+	ScratchPool<Node> _nodes;
+	std::vector<Ring> _rings;
+	std::vector<const Ring*> _holes;
+	std::vector<Node*> _holeQueue;
+	ElementArray _triangles;
+
+	//z-order hashing of big polygons
+	double _minX = 0.0, _minY = 0.0, _invSize = 0.0;
+};
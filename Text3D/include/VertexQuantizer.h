@@ -0,0 +1,55 @@
+//the compact vertex of the text meshes
+//a position is quantized to 3 unorm16 relative to the bounds of its mesh, a normal is octahedral encoded to 2 snorm16,
+//the texcoord is dropped because text never uses it, so a vertex is 12 bytes instead of the 32 bytes of the renderer's Vertex
+//the decoding matches opengl's normalized integer attributes, so the shader gets [0, 1] positions and [-1, 1] normals
+#pragma once
+
+#include <vector>
+
+#include <glad\glad.h>
+#include <glm\glm.hpp>
+
+#include "Glyph3D.h"
+
+struct QuantizedVertex
+{
+	GLushort position[3];   //unorm16 in the bounds of the mesh
+	GLushort reserved;      //keeps the normal 4 bytes aligned for the vertex fetch
+	GLshort normal[2];      //octahedral encoded, snorm16
+};
+
+static_assert(sizeof(QuantizedVertex) == 12, "QuantizedVertex must be 12 bytes");
+
+//position = offset + scale * unorm16
+struct QuantizationBounds
+{
+	glm::vec3 offset;   //the min corner of the mesh
+	glm::vec3 scale;    //the size of the mesh
+};
+
+//the max errors of a quantized mesh
+struct QuantizationError
+{
+	float position;      //the distance between the original and the decoded positions
+	float normalAngle;   //the angle between the original and the decoded normals in degrees
+};
+
+//the bounds of the positions, an empty array gets zero bounds
+QuantizationBounds computeQuantizationBounds(const Vec3Array &positions);
+
+//n must be normalized
+void octEncode(const glm::vec3 &n, GLshort out[2]);
+glm::vec3 octDecode(const GLshort in[2]);
+
+QuantizedVertex quantizeVertex(const glm::vec3 &position, const glm::vec3 &normal, const QuantizationBounds &bounds);
+glm::vec3 dequantizePosition(const QuantizedVertex &v, const QuantizationBounds &bounds);
+glm::vec3 dequantizeNormal(const QuantizedVertex &v);
+
+//quantize the output of computeGlyphGeometry, return the bounds the shader needs to decode the positions
+QuantizationBounds quantizeGlyph(const Glyph3D &glyph, std::vector<QuantizedVertex> &out);
+
+//decode the vertices and compare them with the original ones
+QuantizationError measureQuantizationError(const Vec3Array &positions, const Vec3Array &normals,
+	const QuantizedVertex *vertices, const QuantizationBounds &bounds);
+//the errors the format guarantees: half a step on every axis of the bounds and the worst angle of the octahedral grid
+QuantizationError maxQuantizationError(const QuantizationBounds &bounds);
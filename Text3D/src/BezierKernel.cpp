@@ -0,0 +1,159 @@
+#include "..\include\BezierKernel.h"
+
+#include <algorithm>
+
+#if defined(__AVX__)
+#define BEZIER_KERNEL_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BEZIER_KERNEL_SSE
+#include <emmintrin.h>
+#endif
+
+void BezierBatch::reserve(unsigned int n)
+{
+	for (auto v : { &ax, &ay, &bx, &by, &cx, &cy, &dx, &dy })
+		v->reserve(n);
+	steps.reserve(n);
+	first.reserve(n);
+}
+
+void BezierBatch::clear()
+{
+	for (auto v : { &ax, &ay, &bx, &by, &cx, &cy, &dx, &dy })
+		v->clear();
+	steps.clear();
+	first.clear();
+	num_samples = 0;
+}
+
+unsigned int BezierBatch::add(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c, const glm::vec2 &d, unsigned int num_steps)
+{
+	ax.push_back(a.x); ay.push_back(a.y);
+	bx.push_back(b.x); by.push_back(b.y);
+	cx.push_back(c.x); cy.push_back(c.y);
+	dx.push_back(d.x); dy.push_back(d.y);
+	steps.push_back(num_steps);
+	first.push_back(num_samples);
+	num_samples += num_steps - 1;
+	return steps.size() - 1;
+}
+
+unsigned int BezierBatch::addConic(const glm::vec2 &p0, const glm::vec2 &p1, const glm::vec2 &p2, unsigned int num_steps)
+{
+	return add(glm::vec2(0.0f, 0.0f), p0 - p1 * 2.0f + p2, (p1 - p0) * 2.0f, p0, num_steps);
+}
+
+unsigned int BezierBatch::addCubic(const glm::vec2 &p0, const glm::vec2 &p1, const glm::vec2 &p2, const glm::vec2 &p3, unsigned int num_steps)
+{
+	glm::vec2 c = (p1 - p0) * 3.0f;
+	glm::vec2 b = (p2 - p1) * 3.0f - c;
+	glm::vec2 a = p3 - p0 - c - b;
+	return add(a, b, c, p0, num_steps);
+}
+
+//evaluate the curves [begin, end) one by one
+static void evaluateRange(const BezierBatch &batch, unsigned int begin, unsigned int end, glm::vec2 *samples)
+{
+	for (unsigned int s = begin; s < end; ++s)
+	{
+		float dt = 1.0f / float(batch.steps[s]);
+		glm::vec2 *out = samples + batch.first[s];
+		for (unsigned int k = 1; k < batch.steps[s]; ++k)
+		{
+			float u = float(k) * dt;
+			out[k - 1].x = ((batch.ax[s] * u + batch.bx[s]) * u + batch.cx[s]) * u + batch.dx[s];
+			out[k - 1].y = ((batch.ay[s] * u + batch.by[s]) * u + batch.cy[s]) * u + batch.dy[s];
+		}
+	}
+}
+
+void evaluateBezierBatchScalar(const BezierBatch &batch, glm::vec2 *samples)
+{
+	evaluateRange(batch, 0, batch.size(), samples);
+}
+
+#if defined(BEZIER_KERNEL_AVX)
+
+void evaluateBezierBatch(const BezierBatch &batch, glm::vec2 *samples)
+{
+	const unsigned int n = batch.size();
+	float xs[8], ys[8];
+
+	unsigned int s = 0;
+	for (; s + 8 <= n; s += 8)
+	{
+		const unsigned int *steps = &batch.steps[s];
+		unsigned int maxSteps = *std::max_element(steps, steps + 8);
+		if (maxSteps < 2) continue;
+
+		__m256 dt = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)steps)));
+		__m256 ax = _mm256_loadu_ps(&batch.ax[s]), bx = _mm256_loadu_ps(&batch.bx[s]), cx = _mm256_loadu_ps(&batch.cx[s]), dx = _mm256_loadu_ps(&batch.dx[s]);
+		__m256 ay = _mm256_loadu_ps(&batch.ay[s]), by = _mm256_loadu_ps(&batch.by[s]), cy = _mm256_loadu_ps(&batch.cy[s]), dy = _mm256_loadu_ps(&batch.dy[s]);
+
+		//the k-th sample of the 8 curves, lanes whose curve has fewer samples are dropped
+		for (unsigned int k = 1; k < maxSteps; ++k)
+		{
+			__m256 u = _mm256_mul_ps(_mm256_set1_ps(float(k)), dt);
+			__m256 x = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(ax, u), bx), u), cx), u), dx);
+			__m256 y = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(ay, u), by), u), cy), u), dy);
+			_mm256_storeu_ps(xs, x);
+			_mm256_storeu_ps(ys, y);
+
+			for (unsigned int l = 0; l < 8; ++l)
+				if (k < steps[l])
+					samples[batch.first[s + l] + k - 1] = glm::vec2(xs[l], ys[l]);
+		}
+	}
+	evaluateRange(batch, s, n, samples);
+}
+
+const char* bezierKernelName() { return "AVX"; }
+
+#elif defined(BEZIER_KERNEL_SSE)
+
+void evaluateBezierBatch(const BezierBatch &batch, glm::vec2 *samples)
+{
+	const unsigned int n = batch.size();
+	float xs[4], ys[4];
+
+	unsigned int s = 0;
+	for (; s + 4 <= n; s += 4)
+	{
+		const unsigned int *steps = &batch.steps[s];
+		unsigned int maxSteps = *std::max_element(steps, steps + 4);
+		if (maxSteps < 2) continue;
+
+		__m128 dt = _mm_div_ps(_mm_set1_ps(1.0f), _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)steps)));
+		__m128 ax = _mm_loadu_ps(&batch.ax[s]), bx = _mm_loadu_ps(&batch.bx[s]), cx = _mm_loadu_ps(&batch.cx[s]), dx = _mm_loadu_ps(&batch.dx[s]);
+		__m128 ay = _mm_loadu_ps(&batch.ay[s]), by = _mm_loadu_ps(&batch.by[s]), cy = _mm_loadu_ps(&batch.cy[s]), dy = _mm_loadu_ps(&batch.dy[s]);
+
+		//the k-th sample of the 4 curves, lanes whose curve has fewer samples are dropped
+		for (unsigned int k = 1; k < maxSteps; ++k)
+		{
+			__m128 u = _mm_mul_ps(_mm_set1_ps(float(k)), dt);
+			__m128 x = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ax, u), bx), u), cx), u), dx);
+			__m128 y = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ay, u), by), u), cy), u), dy);
+			_mm_storeu_ps(xs, x);
+			_mm_storeu_ps(ys, y);
+
+			for (unsigned int l = 0; l < 4; ++l)
+				if (k < steps[l])
+					samples[batch.first[s + l] + k - 1] = glm::vec2(xs[l], ys[l]);
+		}
+	}
+	evaluateRange(batch, s, n, samples);
+}
+
+const char* bezierKernelName() { return "SSE"; }
+
+#else
+
+void evaluateBezierBatch(const BezierBatch &batch, glm::vec2 *samples)
+{
+	evaluateRange(batch, 0, batch.size(), samples);
+}
+
+const char* bezierKernelName() { return "scalar"; }
+
+#endif
@@ -0,0 +1,167 @@
+#include "..\include\FontRegistry.h"
+
+#include <chrono>
+#include <algorithm>
+
+FontRegistry::FontRegistry() :
+_ft(nullptr)
+{
+	if (FT_Init_FreeType(&_ft))
+	{
+		std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+		_ft = nullptr;
+	}
+}
+
+FontRegistry::~FontRegistry()
+{
+	//faces must be released before the mappings they read from
+	for (auto &f : _faces)
+	{
+		FT_Done_Face(f.second->face);
+		delete f.second;
+	}
+	for (auto f : _threadFaces)
+	{
+		FT_Done_Face(f->face);
+		delete f;
+	}
+	for (auto &f : _files)
+		delete f.second;
+
+	if (_ft)
+		FT_Done_FreeType(_ft);
+}
+
+FontFile* FontRegistry::getFile(const std::string &font_file)
+{
+	auto itr = _files.find(font_file);
+	if (itr != _files.end())
+		return itr->second;
+
+	auto t0 = std::chrono::high_resolution_clock::now();
+
+	FontFile *file = new FontFile;
+	file->path = font_file;
+	if (!file->mapping.open(font_file))
+	{
+		std::cout << "ERROR::FREETYPE: Failed to map font file " << font_file << std::endl;
+		delete file;
+		return nullptr;
+	}
+
+	auto t1 = std::chrono::high_resolution_clock::now();
+	file->mapTime = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+	_files[font_file] = file;
+	return file;
+}
+
+FontFace* FontRegistry::openFace(FontFile *file, FT_Long face_index, FT_UInt pixel_size)
+{
+	auto t0 = std::chrono::high_resolution_clock::now();
+
+	//the memory face keeps a pointer to the mapping, no copy of the font data is made
+	FT_Face face;
+	if (FT_New_Memory_Face(_ft, file->mapping.data(), (FT_Long)file->mapping.size(), face_index, &face))
+	{
+		std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+		return nullptr;
+	}
+	FT_Set_Pixel_Sizes(face, 0, pixel_size);
+
+	auto t1 = std::chrono::high_resolution_clock::now();
+	double openTime = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+	unsigned int id = getFaceId(file->path, face_index, pixel_size);
+	return new FontFace{ id, file, face_index, pixel_size, face, openTime };
+}
+
+unsigned int FontRegistry::getFaceId(const std::string &font_file, FT_Long face_index, FT_UInt pixel_size)
+{
+	FaceKey key{ font_file, face_index, pixel_size };
+	auto itr = _faceIds.find(key);
+	if (itr != _faceIds.end())
+		return itr->second;
+
+	unsigned int id = _faceIds.size();
+	_faceIds[key] = id;
+	return id;
+}
+
+FontFace* FontRegistry::getFace(const std::string &font_file, FT_Long face_index, FT_UInt pixel_size)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	FaceKey key{ font_file, face_index, pixel_size };
+	auto itr = _faces.find(key);
+	if (itr != _faces.end())
+		return itr->second;
+
+	if (!_ft) return nullptr;
+
+	FontFile *file = getFile(font_file);
+	if (!file) return nullptr;
+
+	FontFace *fontFace = openFace(file, face_index, pixel_size);
+	if (fontFace)
+		_faces[key] = fontFace;
+	return fontFace;
+}
+
+FontFace* FontRegistry::createFace(const std::string &font_file, FT_Long face_index, FT_UInt pixel_size)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (!_ft) return nullptr;
+
+	FontFile *file = getFile(font_file);
+	if (!file) return nullptr;
+
+	FontFace *fontFace = openFace(file, face_index, pixel_size);
+	if (fontFace)
+		_threadFaces.push_back(fontFace);
+	return fontFace;
+}
+
+void FontRegistry::releaseFace(FontFace *font_face)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto itr = std::find(_threadFaces.begin(), _threadFaces.end(), font_face);
+	if (itr == _threadFaces.end())
+		return;
+
+	FT_Done_Face(font_face->face);
+	delete font_face;
+	_threadFaces.erase(itr);
+}
+
+void FontRegistry::printStats(std::ostream &os) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for (const auto &f : _files)
+	{
+		const FontFile *file = f.second;
+
+		unsigned int faces = 0;
+		double openTime = 0.0;
+		for (const auto &face : _faces)
+		{
+			if (face.second->file != file) continue;
+			++faces;
+			openTime += face.second->openTime;
+		}
+		for (auto face : _threadFaces)
+		{
+			if (face->file != file) continue;
+			++faces;
+			openTime += face->openTime;
+		}
+
+		os << file->path << ": mapped " << file->mapping.size() / 1024 << " KB, resident "
+			<< file->mapping.residentBytes() / 1024 << " KB, map " << file->mapTime << " ms, "
+			<< faces << " faces opened in " << openTime << " ms" << std::endl;
+	}
+}
@@ -0,0 +1,147 @@
+#include "..\include\FreeTypeFont.h"
+
+namespace FreeType
+{
+	inline glm::vec2 toVec2(const FT_Vector &v) { return glm::vec2(v.x, v.y); }
+
+	bool decomposeOutline(const FT_Outline &outline, Char3DInfo &char3d)
+	{
+		const FT_Vector *points = outline.points;
+		const unsigned char *tags = (const unsigned char*)outline.tags;
+
+		char3d.reserve(outline.n_points, outline.n_contours);
+
+		int last = -1;
+		for (int n = 0; n < outline.n_contours; ++n)
+		{
+			int first = last + 1;
+			last = outline.contours[n];
+			if (last < first) return false;
+
+			int i = first;
+			int limit = last;
+			FT_Vector v_start = points[first];
+			FT_Vector v_control;
+
+			//a contour cannot start with a cubic control point
+			int tag = FT_CURVE_TAG(tags[first]);
+			if (tag == FT_CURVE_TAG_CUBIC) return false;
+			//the first point is a conic control point
+			if (tag == FT_CURVE_TAG_CONIC)
+			{
+				//start at the last point if it is on the curve, otherwise at the middle of the first and last points
+				if (FT_CURVE_TAG(tags[last]) == FT_CURVE_TAG_ON)
+				{
+					v_start = points[last];
+					--limit;
+				}
+				else
+				{
+					v_start.x = (v_start.x + points[last].x) / 2;
+					v_start.y = (v_start.y + points[last].y) / 2;
+				}
+				--i;
+			}
+
+			char3d.moveTo(toVec2(v_start));
+
+			bool closed = false;
+			while (i < limit && !closed)
+			{
+				++i;
+				switch (FT_CURVE_TAG(tags[i]))
+				{
+				case FT_CURVE_TAG_ON:
+					char3d.lineTo(toVec2(points[i]));
+					break;
+
+				case FT_CURVE_TAG_CONIC:
+					//consume conic arcs, two successive control points imply an on point at their middle
+					v_control = points[i];
+					for (;;)
+					{
+						if (i >= limit)
+						{
+							char3d.conicTo(toVec2(v_control), toVec2(v_start));
+							closed = true;
+							break;
+						}
+						++i;
+						tag = FT_CURVE_TAG(tags[i]);
+						if (tag == FT_CURVE_TAG_ON)
+						{
+							char3d.conicTo(toVec2(v_control), toVec2(points[i]));
+							break;
+						}
+						if (tag != FT_CURVE_TAG_CONIC) return false;
+
+						FT_Vector v_middle;
+						v_middle.x = (v_control.x + points[i].x) / 2;
+						v_middle.y = (v_control.y + points[i].y) / 2;
+						char3d.conicTo(toVec2(v_control), toVec2(v_middle));
+						v_control = points[i];
+					}
+					break;
+
+				default:   //FT_CURVE_TAG_CUBIC
+					if (i + 1 > limit || FT_CURVE_TAG(tags[i + 1]) != FT_CURVE_TAG_CUBIC) return false;
+					i += 2;
+					if (i <= limit)
+						char3d.cubicTo(toVec2(points[i - 2]), toVec2(points[i - 1]), toVec2(points[i]));
+					else
+					{
+						char3d.cubicTo(toVec2(points[i - 2]), toVec2(points[i - 1]), toVec2(v_start));
+						closed = true;
+					}
+					break;
+				}
+			}
+
+			//close the contour with a line segment
+			if (!closed)
+				char3d.lineTo(toVec2(v_start));
+		}
+		return true;
+	}
+}   //close namespace FreeType
+
+FreeTypeFont::FreeTypeFont(FontFace *font_face, FT_UInt glyph_index, float tolerance) :
+glyph_index(glyph_index), glyph(nullptr), AdvanceX(0), char3d(tolerance)
+{
+	if (!font_face)
+	{
+		std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+		return;
+	}
+	FT_Face face = font_face->face;
+
+	//load glyph face
+	FT_Error error = FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
+	if (error)
+		std::cout << "FT_Load_Glyph(...) error 0x" << std::hex << error << std::dec << std::endl;
+	if (face->glyph->format != FT_GLYPH_FORMAT_OUTLINE)
+		std::cout << "FreeTypeFont3D::getGlyph : not a vector font" << std::endl;
+
+	AdvanceX = (face->glyph->advance.x) >> 6;
+
+	if (!error && FT_Get_Glyph(face->glyph, &glyph))
+		glyph = nullptr;
+}
+
+FreeTypeFont::~FreeTypeFont()
+{
+	if (glyph)
+		FT_Done_Glyph(glyph);
+}
+
+Glyph3D FreeTypeFont::getGlyph3D()
+{
+	if (!glyph || glyph->format != FT_GLYPH_FORMAT_OUTLINE)
+		return char3d.get();
+
+	const FT_Outline &outline = ((FT_OutlineGlyph)glyph)->outline;
+	if (!FreeType::decomposeOutline(outline, char3d))
+		std::cout << "FreeTypeFont3D::getGlyph : - outline decompose failed ..." << std::endl;
+
+	return char3d.get();
+}
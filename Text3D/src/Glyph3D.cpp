@@ -18,15 +18,6 @@ bool Glyph3D::removeElements(unsigned int b, unsigned int numToRemove)
 	}
 }
 
-Vec3Array Glyph3D::getNormalArray() const
-{
-	Vec3Array normal;
-	for (const auto &norm : _normals)
-		for (const auto &n : norm)
-			normal.push_back(n);
-	return normal;
-}
-
 ElementArray Glyph3D::getIndices() const
 {
 	ElementArray indices;
@@ -37,16 +28,6 @@ ElementArray Glyph3D::getIndices() const
 	return indices;
 }
 
-void Glyph3D::accept(PrimitiveIndexFunctor& functor) const
-{
-	const Vec3Array* vertices = &_vertices;
-
-	if (!vertices || vertices->size() == 0) return;
-
-	for (unsigned int i = 0; i < _elements.size(); ++i)
-		functor.drawElements(_modeList[i], _elements[i].size(), &(_elements[i].front()));
-}
-
 void Glyph3D::output()
 {
 	std::ofstream fout;
@@ -72,7 +53,7 @@ void Glyph3D::output()
 	fout << std::endl << std::endl;
 
 	fout << "Normals:" << std::endl;
-	Vec3Array normals = getNormalArray();
+	const Vec3Array &normals = getNormalArray();
 	fout << "Size of normals: " << normals.size() << std::endl;
 	for (auto norm : normals)
 		fout << norm.x << ", " << norm.y << ", " << norm.z << std::endl;
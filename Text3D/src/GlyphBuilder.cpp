@@ -0,0 +1,205 @@
+#include "..\include\GlyphBuilder.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "..\include\FreeTypeFont.h"
+
+GlyphBuilder::GlyphBuilder(FontRegistry &fonts, unsigned int num_threads) :
+_fonts(fonts),
+_job(nullptr),
+_generation(0),
+_quit(false)
+{
+	if (num_threads == 0)
+		num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned int i = 0; i < num_threads; ++i)
+		_workers.push_back(new Worker);
+	for (auto worker : _workers)
+		worker->thread = std::thread(&GlyphBuilder::run, this, worker);
+}
+
+GlyphBuilder::~GlyphBuilder()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_quit = true;
+	}
+	_wake.notify_all();
+
+	for (auto worker : _workers)
+	{
+		worker->thread.join();
+		for (auto &face : worker->faces)
+			_fonts.releaseFace(face.second);
+		delete worker;
+	}
+}
+
+std::vector<std::shared_ptr<const GlyphMesh>> GlyphBuilder::build(FontFace *font_face, const std::wstring &text,
+	float tolerance, float depth, float crease_angle, GlyphMeshCache *cache)
+{
+	return build(font_face, std::vector<FT_ULong>(text.begin(), text.end()), tolerance, depth, crease_angle, cache);
+}
+
+std::vector<std::shared_ptr<const GlyphMesh>> GlyphBuilder::build(FontFace *font_face, const std::vector<FT_ULong> &charcodes,
+	float tolerance, float depth, float crease_angle, GlyphMeshCache *cache)
+{
+	std::vector<std::shared_ptr<const GlyphMesh>> result(charcodes.size());
+	if (!font_face || charcodes.empty()) return result;
+
+	Job job{ font_face, tolerance, depth, crease_angle, cache, {}, {}, 0 };
+
+	//every glyph is built once, the cached ones are not built at all
+	std::vector<FT_UInt> charGlyphs(charcodes.size());
+	std::unordered_map<FT_UInt, unsigned int> glyphSlots;
+	std::unordered_map<FT_UInt, std::shared_ptr<const GlyphMesh>> cached;
+	for (size_t i = 0; i < charcodes.size(); ++i)
+	{
+		FT_UInt index = font_face->glyphIndex(charcodes[i]);
+		charGlyphs[i] = index;
+		if (glyphSlots.count(index) || cached.count(index)) continue;
+
+		std::shared_ptr<const GlyphMesh> mesh;
+		if (cache)
+			mesh = cache->find(GlyphMeshKey{ font_face->id, index, tolerance, depth, crease_angle });
+		if (mesh)
+			cached[index] = mesh;
+		else
+		{
+			glyphSlots[index] = job.glyphs.size();
+			job.glyphs.push_back(index);
+		}
+	}
+	job.meshes.resize(job.glyphs.size());
+
+	if (!job.glyphs.empty())
+	{
+		//several small chunks per worker, so the workers that finish early have something to steal
+		const unsigned int numWorkers = _workers.size();
+		const unsigned int numGlyphs = job.glyphs.size();
+		const unsigned int chunkSize = std::max(1u, numGlyphs / (numWorkers * 8));
+		for (unsigned int w = 0; w < numWorkers; ++w)
+		{
+			Worker *worker = _workers[w];
+			std::lock_guard<std::mutex> lock(worker->mutex);
+			worker->chunks.clear();
+			worker->built = worker->stolen = 0;
+			worker->cacheBefore = worker->cacheAfter = VertexCacheStats();
+
+			unsigned int end = static_cast<unsigned long long>(numGlyphs) * (w + 1) / numWorkers;
+			for (unsigned int begin = static_cast<unsigned long long>(numGlyphs) * w / numWorkers; begin < end; begin += chunkSize)
+				worker->chunks.push_back(Chunk{ begin, std::min(begin + chunkSize, end) });
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		job.activeWorkers = numWorkers;
+		_job = &job;
+		++_generation;
+		_wake.notify_all();
+		_done.wait(lock, [&job]() { return job.activeWorkers == 0; });
+		_job = nullptr;
+	}
+
+	for (size_t i = 0; i < charcodes.size(); ++i)
+	{
+		auto slot = glyphSlots.find(charGlyphs[i]);
+		result[i] = slot != glyphSlots.end() ? job.meshes[slot->second] : cached[charGlyphs[i]];
+	}
+	return result;
+}
+
+void GlyphBuilder::run(Worker *worker)
+{
+	unsigned int generation = 0;
+	for (;;)
+	{
+		Job *job;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [this, generation]() { return _quit || _generation != generation; });
+			if (_quit) return;
+			generation = _generation;
+			job = _job;
+		}
+
+		//all chunks are posted before the workers wake up, no chunk left anywhere means the job is done
+		Chunk chunk;
+		while (popChunk(worker, chunk) || stealChunk(worker, chunk))
+			for (unsigned int i = chunk.begin; i < chunk.end; ++i)
+				buildGlyph(worker, *job, i);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (--job->activeWorkers == 0)
+			_done.notify_all();
+	}
+}
+
+bool GlyphBuilder::popChunk(Worker *worker, Chunk &chunk)
+{
+	std::lock_guard<std::mutex> lock(worker->mutex);
+	if (worker->chunks.empty()) return false;
+	chunk = worker->chunks.front();
+	worker->chunks.pop_front();
+	return true;
+}
+
+bool GlyphBuilder::stealChunk(Worker *worker, Chunk &chunk)
+{
+	//start from the next worker, so the thieves don't all rob the same victim
+	unsigned int self = std::find(_workers.begin(), _workers.end(), worker) - _workers.begin();
+	for (unsigned int k = 1; k < _workers.size(); ++k)
+	{
+		Worker *victim = _workers[(self + k) % _workers.size()];
+		std::lock_guard<std::mutex> lock(victim->mutex);
+		if (victim->chunks.empty()) continue;
+		chunk = victim->chunks.back();
+		victim->chunks.pop_back();
+		++worker->stolen;
+		return true;
+	}
+	return false;
+}
+
+void GlyphBuilder::buildGlyph(Worker *worker, Job &job, unsigned int i)
+{
+	//the FT_Face of the job belongs to the calling thread, every worker opens its own one
+	FontFace *&face = worker->faces[job.fontFace->id];
+	if (!face)
+		face = _fonts.createFace(job.fontFace->file->path, job.fontFace->faceIndex, job.fontFace->pixelSize);
+
+	FT_UInt index = job.glyphs[i];
+	FreeTypeFont font(face, index, job.tolerance);
+	//a glyph that can't be loaded is no mesh, unlike a glyph without outline
+	if (!font.isValid())
+		return;
+	std::shared_ptr<GlyphMesh> mesh = std::make_shared<GlyphMesh>();
+	mesh->glyph = font.getGlyph3D();
+	mesh->advanceX = font.advanceX();
+	if (!computeGlyphGeometry(mesh->glyph, job.depth, worker->tessellator, job.creaseAngle))
+		return;
+	optimizeGlyphMesh(mesh->glyph, TIPSIFY, &worker->cacheBefore, &worker->cacheAfter);
+
+	job.meshes[i] = mesh;
+	if (job.cache)
+		job.cache->insert(GlyphMeshKey{ job.fontFace->id, index, job.tolerance, job.depth, job.creaseAngle }, mesh);
+	++worker->built;
+}
+
+void GlyphBuilder::printStats(std::ostream &os) const
+{
+	os << "Glyph builder: " << _workers.size() << " workers";
+	for (size_t w = 0; w < _workers.size(); ++w)
+		os << (w ? ", " : ": ") << _workers[w]->built << " built/" << _workers[w]->stolen << " stolen";
+	os << std::endl;
+
+	VertexCacheStats before, after;
+	for (auto worker : _workers)
+	{
+		before.add(worker->cacheBefore);
+		after.add(worker->cacheAfter);
+	}
+	if (after.triangles)
+		printVertexCacheStats(os, "Glyph builder", before, after);
+}
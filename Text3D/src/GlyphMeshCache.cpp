@@ -0,0 +1,155 @@
+#include "..\include\GlyphMeshCache.h"
+
+#include <cstring>
+
+#include "..\include\FreeTypeFont.h"
+#include "..\include\Tessellator.h"
+
+size_t GlyphMesh::memorySize() const
+{
+	size_t size = sizeof(GlyphMesh);
+	size += glyph._vertices.capacity() * sizeof(glm::vec3);
+	size += glyph._normals.capacity() * sizeof(glm::vec3);
+	for (const auto &e : glyph._elements)
+		size += sizeof(ElementArray) + e.capacity() * sizeof(unsigned int);
+	size += glyph._modeList.capacity() * sizeof(GLenum);
+	return size;
+}
+
+size_t GlyphMeshKeyHash::operator()(const GlyphMeshKey &key) const
+{
+	unsigned int tolerance, depth, creaseAngle;
+	std::memcpy(&tolerance, &key.tolerance, sizeof(float));
+	std::memcpy(&depth, &key.depth, sizeof(float));
+	std::memcpy(&creaseAngle, &key.creaseAngle, sizeof(float));
+
+	size_t h = key.fontId;
+	h = h * 31 + key.glyphIndex;
+	h = h * 31 + tolerance;
+	h = h * 31 + depth;
+	h = h * 31 + creaseAngle;
+	return h;
+}
+
+GlyphMeshCache::GlyphMeshCache(size_t budget) :
+_budget(budget),
+_memory(0),
+_hits(0),
+_misses(0),
+_evictions(0)
+{
+}
+
+std::shared_ptr<const GlyphMesh> GlyphMeshCache::get(FontFace *font_face, FT_UInt glyph_index, float tolerance, float depth,
+	float crease_angle)
+{
+	if (!font_face) return nullptr;
+
+	GlyphMeshKey key{ font_face->id, glyph_index, tolerance, depth, crease_angle };
+	std::shared_ptr<const GlyphMesh> mesh = find(key);
+	if (mesh) return mesh;
+
+	//build the glyph outside of the lock
+	FreeTypeFont font(font_face, glyph_index, tolerance);
+	//a glyph that can't be loaded isn't cached, the next get tries again
+	if (!font.isValid())
+		return nullptr;
+	std::shared_ptr<GlyphMesh> built = std::make_shared<GlyphMesh>();
+	built->glyph = font.getGlyph3D();
+	built->advanceX = font.advanceX();
+	if (!computeGlyphGeometry(built->glyph, depth, crease_angle))
+		return nullptr;
+	VertexCacheStats before, after;
+	optimizeGlyphMesh(built->glyph, TIPSIFY, &before, &after);
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_cacheBefore.add(before);
+		_cacheAfter.add(after);
+	}
+	insert(key, built);
+	return built;
+}
+
+std::shared_ptr<const GlyphMesh> GlyphMeshCache::find(const GlyphMeshKey &key)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto itr = _index.find(key);
+	if (itr == _index.end())
+	{
+		++_misses;
+		return nullptr;
+	}
+
+	++_hits;
+	_lru.splice(_lru.begin(), _lru, itr->second);
+	return itr->second->second;
+}
+
+void GlyphMeshCache::insert(const GlyphMeshKey &key, const std::shared_ptr<const GlyphMesh> &mesh)
+{
+	if (!mesh) return;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto itr = _index.find(key);
+	if (itr != _index.end())
+	{
+		//another thread built the same glyph first, keep the newer mesh
+		_memory -= itr->second->second->memorySize();
+		_lru.erase(itr->second);
+		_index.erase(itr);
+	}
+
+	_lru.emplace_front(key, mesh);
+	_index[key] = _lru.begin();
+	_memory += mesh->memorySize();
+
+	evict();
+}
+
+void GlyphMeshCache::evict()
+{
+	//the mesh just inserted is never evicted, even if it is bigger than the budget
+	while (_memory > _budget && _lru.size() > 1)
+	{
+		Entry &entry = _lru.back();
+		_memory -= entry.second->memorySize();
+		_index.erase(entry.first);
+		_lru.pop_back();
+		++_evictions;
+	}
+}
+
+void GlyphMeshCache::setBudget(size_t budget)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_budget = budget;
+	evict();
+}
+
+void GlyphMeshCache::clear()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_lru.clear();
+	_index.clear();
+	_memory = 0;
+}
+
+void GlyphMeshCache::resetCounters()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_hits = _misses = _evictions = 0;
+	_cacheBefore = _cacheAfter = VertexCacheStats();
+}
+
+void GlyphMeshCache::printStats(std::ostream &os) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	os << "Glyph mesh cache: " << _index.size() << " meshes, " << _memory / 1024 << " KB of "
+		<< _budget / 1024 << " KB, hits " << _hits << ", misses " << _misses
+		<< ", evictions " << _evictions << std::endl;
+	if (_cacheAfter.triangles)
+		printVertexCacheStats(os, "Glyph mesh cache", _cacheBefore, _cacheAfter);
+}
@@ -0,0 +1,221 @@
+#include "..\include\GlyphPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "..\include\GlyphMeshCache.h"
+
+//every section starts at a 16 bytes boundary
+static unsigned int alignOffset(size_t offset)
+{
+	return static_cast<unsigned int>((offset + 15) & ~size_t(15));
+}
+
+GlyphPackWriter::GlyphPackWriter(unsigned int pixel_size, float tolerance, float depth, float crease_angle)
+{
+	std::memset(&_header, 0, sizeof(_header));
+	std::memcpy(_header.magic, GlyphPackMagic, sizeof(GlyphPackMagic));
+	_header.version = GlyphPackVersion;
+	_header.headerSize = sizeof(GlyphPackHeader);
+	_header.vertexStride = sizeof(GlyphPackVertex);
+	_header.pixelSize = pixel_size;
+	_header.tolerance = tolerance;
+	_header.depth = depth;
+	_header.creaseAngle = crease_angle;
+}
+
+GlyphPackGlyph GlyphPackWriter::convert(FT_UInt glyph_index, const GlyphMesh &mesh)
+{
+	const Glyph3D &glyph = mesh.glyph;
+
+	GlyphPackGlyph out;
+	GlyphPackEntry &entry = out.entry;
+	std::memset(&entry, 0, sizeof(entry));
+	entry.glyphIndex = glyph_index;
+	entry.advanceX = mesh.advanceX;
+
+	//the mesh is indexed already, its vertices are quantized in its bounds
+	out.indices = glyph.getIndices();
+	QuantizationBounds bounds = quantizeGlyph(glyph, out.vertices);
+
+	entry.vertexCount = out.vertices.size();
+	entry.indexCount = out.indices.size();
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		entry.boundsMin[i] = bounds.offset[i];
+		entry.boundsMax[i] = bounds.offset[i] + bounds.scale[i];
+	}
+	return out;
+}
+
+void GlyphPackWriter::addGlyph(FT_ULong charcode, FT_UInt glyph_index, const GlyphMesh &mesh)
+{
+	if (_glyphs.count(glyph_index))
+		addChar(charcode, glyph_index);
+	else
+		addGlyph(charcode, convert(glyph_index, mesh));
+}
+
+void GlyphPackWriter::addGlyph(FT_ULong charcode, const GlyphPackGlyph &glyph)
+{
+	addChar(charcode, glyph.entry.glyphIndex);
+	if (!_glyphs.insert(glyph.entry.glyphIndex).second) return;
+
+	GlyphPackEntry entry = glyph.entry;
+	entry.firstVertex = _vertices.size();
+	entry.firstIndex = _indices.size();
+	_vertices.insert(_vertices.end(), glyph.vertices.begin(), glyph.vertices.end());
+	_indices.insert(_indices.end(), glyph.indices.begin(), glyph.indices.end());
+	_entries.push_back(entry);
+}
+
+void GlyphPackWriter::addChar(FT_ULong charcode, FT_UInt glyph_index)
+{
+	_chars.push_back({ static_cast<unsigned int>(charcode), glyph_index });
+}
+
+bool GlyphPackWriter::write(const std::string &path)
+{
+	std::sort(_entries.begin(), _entries.end(),
+		[](const GlyphPackEntry &a, const GlyphPackEntry &b) { return a.glyphIndex < b.glyphIndex; });
+	std::sort(_chars.begin(), _chars.end(),
+		[](const GlyphPackCharEntry &a, const GlyphPackCharEntry &b) { return a.charcode < b.charcode; });
+	_chars.erase(std::unique(_chars.begin(), _chars.end(),
+		[](const GlyphPackCharEntry &a, const GlyphPackCharEntry &b) { return a.charcode == b.charcode; }), _chars.end());
+
+	GlyphPackHeader header = _header;
+	header.glyphCount = _entries.size();
+	header.charCount = _chars.size();
+	header.vertexCount = _vertices.size();
+	header.indexCount = _indices.size();
+	header.glyphTableOffset = alignOffset(sizeof(GlyphPackHeader));
+	header.charTableOffset = alignOffset(header.glyphTableOffset + _entries.size() * sizeof(GlyphPackEntry));
+	header.vertexDataOffset = alignOffset(header.charTableOffset + _chars.size() * sizeof(GlyphPackCharEntry));
+	header.indexDataOffset = alignOffset(header.vertexDataOffset + _vertices.size() * sizeof(GlyphPackVertex));
+	header.fileSize = header.indexDataOffset + _indices.size() * sizeof(GLuint);
+
+	std::vector<char> data(header.fileSize, 0);
+	std::memcpy(&data[0], &header, sizeof(header));
+	if (!_entries.empty())
+		std::memcpy(&data[header.glyphTableOffset], &_entries[0], _entries.size() * sizeof(GlyphPackEntry));
+	if (!_chars.empty())
+		std::memcpy(&data[header.charTableOffset], &_chars[0], _chars.size() * sizeof(GlyphPackCharEntry));
+	if (!_vertices.empty())
+		std::memcpy(&data[header.vertexDataOffset], &_vertices[0], _vertices.size() * sizeof(GlyphPackVertex));
+	if (!_indices.empty())
+		std::memcpy(&data[header.indexDataOffset], &_indices[0], _indices.size() * sizeof(GLuint));
+
+	std::ofstream fout(path, std::ios::binary);
+	if (!fout)
+	{
+		std::cout << "GlyphPack: Failed to create " << path << std::endl;
+		return false;
+	}
+	fout.write(&data[0], data.size());
+	return bool(fout);
+}
+
+bool GlyphPack::open(const std::string &path)
+{
+	close();
+
+	if (!_file.open(path))
+		return false;
+
+	if (_file.size() < sizeof(GlyphPackHeader))
+	{
+		std::cout << "GlyphPack: " << path << " is too small" << std::endl;
+		close();
+		return false;
+	}
+
+	const unsigned char *data = _file.data();
+	_header = reinterpret_cast<const GlyphPackHeader*>(data);
+	if (!validate())
+	{
+		std::cout << "GlyphPack: " << path << " is not a valid glyph pack of version " << GlyphPackVersion << std::endl;
+		close();
+		return false;
+	}
+
+	_entries = reinterpret_cast<const GlyphPackEntry*>(data + _header->glyphTableOffset);
+	_chars = reinterpret_cast<const GlyphPackCharEntry*>(data + _header->charTableOffset);
+	_vertices = reinterpret_cast<const GlyphPackVertex*>(data + _header->vertexDataOffset);
+	_indices = reinterpret_cast<const GLuint*>(data + _header->indexDataOffset);
+	return true;
+}
+
+void GlyphPack::close()
+{
+	_file.close();
+	_header = nullptr;
+	_entries = nullptr;
+	_chars = nullptr;
+	_vertices = nullptr;
+	_indices = nullptr;
+}
+
+bool GlyphPack::validate() const
+{
+	const GlyphPackHeader &h = *_header;
+	if (std::memcmp(h.magic, GlyphPackMagic, sizeof(GlyphPackMagic)) != 0) return false;
+	if (h.version != GlyphPackVersion) return false;
+	if (h.headerSize != sizeof(GlyphPackHeader) || h.vertexStride != sizeof(GlyphPackVertex)) return false;
+	if (h.fileSize != _file.size()) return false;
+
+	//every section must be aligned and lie inside the file
+	auto inside = [&h](unsigned int offset, unsigned long long count, size_t stride)
+	{
+		return offset % 16 == 0 && offset >= sizeof(GlyphPackHeader) && offset + count * stride <= h.fileSize;
+	};
+	if (!inside(h.glyphTableOffset, h.glyphCount, sizeof(GlyphPackEntry))) return false;
+	if (!inside(h.charTableOffset, h.charCount, sizeof(GlyphPackCharEntry))) return false;
+	if (!inside(h.vertexDataOffset, h.vertexCount, sizeof(GlyphPackVertex))) return false;
+	if (!inside(h.indexDataOffset, h.indexCount, sizeof(GLuint))) return false;
+
+	//every glyph must reference its own data only
+	const GlyphPackEntry *entries = reinterpret_cast<const GlyphPackEntry*>(_file.data() + h.glyphTableOffset);
+	const GLuint *indices = reinterpret_cast<const GLuint*>(_file.data() + h.indexDataOffset);
+	for (unsigned int i = 0; i < h.glyphCount; ++i)
+	{
+		const GlyphPackEntry &e = entries[i];
+		if (i > 0 && entries[i - 1].glyphIndex >= e.glyphIndex) return false;
+		if (static_cast<unsigned long long>(e.firstVertex) + e.vertexCount > h.vertexCount) return false;
+		if (static_cast<unsigned long long>(e.firstIndex) + e.indexCount > h.indexCount) return false;
+		//the indices are uploaded as they are, a triangle list must not reach past the vertices of its glyph
+		if (e.indexCount % 3 != 0) return false;
+		for (unsigned int k = e.firstIndex; k < e.firstIndex + e.indexCount; ++k)
+			if (indices[k] >= e.vertexCount) return false;
+	}
+	return true;
+}
+
+QuantizationBounds GlyphPack::bounds(const GlyphPackEntry &entry)
+{
+	glm::vec3 bmin(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]);
+	glm::vec3 bmax(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]);
+	return QuantizationBounds{ bmin, bmax - bmin };
+}
+
+const GlyphPackEntry* GlyphPack::findGlyph(FT_UInt glyph_index) const
+{
+	if (!isOpen()) return nullptr;
+
+	const GlyphPackEntry *end = _entries + _header->glyphCount;
+	const GlyphPackEntry *itr = std::lower_bound(_entries, end, glyph_index,
+		[](const GlyphPackEntry &e, FT_UInt index) { return e.glyphIndex < index; });
+	if (itr == end || itr->glyphIndex != glyph_index) return nullptr;
+	return itr;
+}
+
+FT_UInt GlyphPack::glyphIndex(FT_ULong charcode) const
+{
+	if (!isOpen()) return 0;
+
+	const GlyphPackCharEntry *end = _chars + _header->charCount;
+	const GlyphPackCharEntry *itr = std::lower_bound(_chars, end, charcode,
+		[](const GlyphPackCharEntry &c, FT_ULong code) { return c.charcode < code; });
+	if (itr == end || itr->charcode != charcode) return 0;
+	return itr->glyphIndex;
+}
@@ -0,0 +1,156 @@
+#include "..\include\MappedFile.h"
+
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() :
+_data(nullptr), _size(0), _file(INVALID_HANDLE_VALUE), _mapping(nullptr) {}
+
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+	_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!_mapping)
+	{
+		close();
+		return false;
+	}
+
+	_data = (const unsigned char*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!_data)
+	{
+		close();
+		return false;
+	}
+	_size = (size_t)size.QuadPart;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle(_mapping);
+	if (_file != INVALID_HANDLE_VALUE)
+		CloseHandle(_file);
+
+	_data = nullptr;
+	_size = 0;
+	_mapping = nullptr;
+	_file = INVALID_HANDLE_VALUE;
+}
+
+size_t MappedFile::residentBytes() const
+{
+	if (!_data) return 0;
+
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	size_t page = info.dwPageSize;
+	size_t pages = (_size + page - 1) / page;
+
+	std::vector<PSAPI_WORKING_SET_EX_INFORMATION> ws(pages);
+	for (size_t i = 0; i < pages; ++i)
+		ws[i].VirtualAddress = (PVOID)(_data + i * page);
+	if (!QueryWorkingSetEx(GetCurrentProcess(), &ws[0], DWORD(pages * sizeof(PSAPI_WORKING_SET_EX_INFORMATION))))
+		return 0;
+
+	size_t resident = 0;
+	for (size_t i = 0; i < pages; ++i)
+		if (ws[i].VirtualAttributes.Valid)
+			resident += page;
+	return resident < _size ? resident : _size;
+}
+
+#else
+
+MappedFile::MappedFile() :
+_data(nullptr), _size(0), _fd(-1) {}
+
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+	_fd = ::open(path.c_str(), O_RDONLY);
+	if (_fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(_fd, &st) != 0 || st.st_size == 0)
+	{
+		close();
+		return false;
+	}
+
+	void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, _fd, 0);
+	if (p == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+	_data = (const unsigned char*)p;
+	_size = st.st_size;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data)
+		munmap((void*)_data, _size);
+	if (_fd >= 0)
+		::close(_fd);
+
+	_data = nullptr;
+	_size = 0;
+	_fd = -1;
+}
+
+size_t MappedFile::residentBytes() const
+{
+	if (!_data) return 0;
+
+	size_t page = sysconf(_SC_PAGESIZE);
+	size_t pages = (_size + page - 1) / page;
+	std::vector<unsigned char> vec(pages);
+	if (mincore((void*)_data, _size, &vec[0]) != 0)
+		return 0;
+
+	size_t resident = 0;
+	for (size_t i = 0; i < pages; ++i)
+		if (vec[i] & 1)
+			resident += page;
+	return resident < _size ? resident : _size;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
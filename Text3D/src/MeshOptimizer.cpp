@@ -0,0 +1,398 @@
+#include "..\include\MeshOptimizer.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace
+{
+	//the scoring of Tom Forsyth's "Linear-Speed Vertex Cache Optimisation", it models a LRU cache of 16 vertices
+	const unsigned int ForsythCacheSize = 16;
+	const float CacheDecayPower = 1.5f;
+	const float LastTriScore = 0.75f;
+	const float ValenceBoostScale = 2.0f;
+	const float ValenceBoostPower = 0.5f;
+	const unsigned int MaxValence = 32;     //the valence boost of bigger valences is computed on the fly
+
+	struct ForsythScores
+	{
+		float cache[ForsythCacheSize];
+		float valence[MaxValence];
+
+		ForsythScores()
+		{
+			for (unsigned int i = 0; i < ForsythCacheSize; ++i)
+			{
+				//the vertices of the last triangle get a fixed score, so the next triangle doesn't just reuse its edge
+				cache[i] = i < 3 ? LastTriScore :
+					std::pow(1.0f - float(i - 3) / (ForsythCacheSize - 3), CacheDecayPower);
+			}
+			valence[0] = 0.0f;
+			for (unsigned int i = 1; i < MaxValence; ++i)
+				valence[i] = ValenceBoostScale * std::pow(float(i), -ValenceBoostPower);
+		}
+
+		float vertexScore(int cache_position, unsigned int live_triangles) const
+		{
+			//a vertex without triangles left will never be used again
+			if (live_triangles == 0) return -1.0f;
+
+			float score = cache_position >= 0 ? cache[cache_position] : 0.0f;
+			if (live_triangles < MaxValence)
+				return score + valence[live_triangles];
+			return score + ValenceBoostScale * std::pow(float(live_triangles), -ValenceBoostPower);
+		}
+	};
+
+	const ForsythScores& forsythScores()
+	{
+		static const ForsythScores scores;
+		return scores;
+	}
+
+	//the triangles of [first, last) with the vertices of the range numbered from 0,
+	//a face of a glyph uses a small range of the vertices, so the work arrays only cover that range
+	struct LocalMesh
+	{
+		unsigned int numTriangles;
+		unsigned int numVertices;
+		unsigned int base;
+		ElementArray indices;
+		std::vector<unsigned int> live;        //the triangles of every vertex not emitted yet
+		std::vector<unsigned int> offsets;     //the triangles of vertex v are adjacency[offsets[v], offsets[v + 1])
+		std::vector<unsigned int> adjacency;
+
+		LocalMesh(const unsigned int *first, const unsigned int *last) :
+		numTriangles((last - first) / 3),
+		numVertices(0),
+		base(0)
+		{
+			if (numTriangles < 2) return;
+
+			const unsigned int *end = first + numTriangles * 3;
+			base = *std::min_element(first, end);
+			numVertices = *std::max_element(first, end) + 1 - base;
+			indices.assign(first, end);
+			for (auto &i : indices)
+				i -= base;
+
+			live.assign(numVertices, 0);
+			for (unsigned int i : indices)
+				++live[i];
+			offsets.assign(numVertices + 1, 0);
+			for (unsigned int v = 0; v < numVertices; ++v)
+				offsets[v + 1] = offsets[v] + live[v];
+			adjacency.resize(indices.size());
+			std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+			for (unsigned int i = 0; i < indices.size(); ++i)
+				adjacency[cursor[indices[i]]++] = i / 3;
+		}
+
+		//write the reordered triangles back to the range
+		void store(const ElementArray &output, unsigned int *first) const
+		{
+			for (unsigned int i : output)
+				*first++ = i + base;
+		}
+	};
+
+	//give the vertices of [first, last) new numbers in the order they are used
+	void assignFetchOrder(unsigned int *first, unsigned int *last, ElementArray &remap, unsigned int &next)
+	{
+		for (unsigned int *i = first; i != last; ++i)
+		{
+			if (remap[*i] == UINT_MAX)
+				remap[*i] = next++;
+			*i = remap[*i];
+		}
+	}
+}
+
+VertexCacheStats analyzeVertexCache(const ElementArray &indices, unsigned int num_vertices, unsigned int cache_size)
+{
+	VertexCacheStats stats;
+	stats.triangles = indices.size() / 3;
+
+	//a FIFO cache: a vertex is cached if it was one of the last cache_size vertices transformed, a hit doesn't refresh it
+	std::vector<unsigned int> timestamps(num_vertices, 0);
+	std::vector<bool> used(num_vertices, false);
+	unsigned int time = cache_size + 1;
+	for (unsigned int i = 0; i < stats.triangles * 3; ++i)
+	{
+		unsigned int v = indices[i];
+		if (v >= num_vertices) continue;
+		if (time - timestamps[v] > cache_size)
+		{
+			timestamps[v] = time++;
+			++stats.transforms;
+		}
+		if (!used[v])
+		{
+			used[v] = true;
+			++stats.vertices;
+		}
+	}
+	return stats;
+}
+
+void optimizeVertexCache(unsigned int *first, unsigned int *last)
+{
+	LocalMesh mesh(first, last);
+	if (mesh.numTriangles < 2) return;
+	const ForsythScores &scores = forsythScores();
+	const unsigned int num_triangles = mesh.numTriangles;
+	const unsigned int num_vertices = mesh.numVertices;
+	const unsigned int *indices = mesh.indices.data();
+	std::vector<unsigned int> &live = mesh.live;
+	std::vector<unsigned int> &adjacency = mesh.adjacency;
+	const std::vector<unsigned int> &offsets = mesh.offsets;
+
+	std::vector<int> cache_position(num_vertices, -1);
+	std::vector<float> vertex_score(num_vertices);
+	for (unsigned int v = 0; v < num_vertices; ++v)
+		vertex_score[v] = scores.vertexScore(-1, live[v]);
+
+	std::vector<bool> emitted(num_triangles, false);
+	unsigned int best = 0;
+	float best_score = -1.0f;
+	for (unsigned int t = 0; t < num_triangles; ++t)
+	{
+		const unsigned int *tri = indices + t * 3;
+		float score = vertex_score[tri[0]] + vertex_score[tri[1]] + vertex_score[tri[2]];
+		if (score > best_score)
+		{
+			best = t;
+			best_score = score;
+		}
+	}
+
+	ElementArray output;
+	output.reserve(num_triangles * 3);
+	unsigned int cache[ForsythCacheSize + 3], new_cache[ForsythCacheSize + 3];
+	unsigned int cache_count = 0;
+	unsigned int scan = 0;
+
+	while (output.size() < num_triangles * 3)
+	{
+		const unsigned int *tri = indices + best * 3;
+		output.insert(output.end(), tri, tri + 3);
+		emitted[best] = true;
+
+		//the vertices of the triangle move to the front of the cache, the rest keep their order
+		unsigned int new_count = 0;
+		for (unsigned int k = 0; k < 3; ++k)
+			new_cache[new_count++] = tri[k];
+		for (unsigned int i = 0; i < cache_count; ++i)
+		{
+			unsigned int v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				new_cache[new_count++] = v;
+		}
+
+		//the triangle is no longer live
+		for (unsigned int k = 0; k < 3; ++k)
+		{
+			unsigned int v = tri[k];
+			unsigned int *list = &adjacency[offsets[v]];
+			unsigned int *end = list + live[v];
+			unsigned int *it = std::find(list, end, best);
+			if (it != end)
+			{
+				*it = *(end - 1);
+				--live[v];
+			}
+		}
+
+		//rescore the cached vertices and their triangles, the vertices pushed out of the cache lose their cache score
+		for (unsigned int i = 0; i < new_count; ++i)
+		{
+			unsigned int v = new_cache[i];
+			cache_position[v] = i < ForsythCacheSize ? int(i) : -1;
+			vertex_score[v] = scores.vertexScore(cache_position[v], live[v]);
+		}
+
+		bool found = false;
+		for (unsigned int i = 0; i < new_count; ++i)
+		{
+			unsigned int v = new_cache[i];
+			for (unsigned int a = offsets[v]; a < offsets[v] + live[v]; ++a)
+			{
+				unsigned int t = adjacency[a];
+				const unsigned int *other = indices + t * 3;
+				float score = vertex_score[other[0]] + vertex_score[other[1]] + vertex_score[other[2]];
+				if (!found || score > best_score)
+				{
+					best = t;
+					best_score = score;
+					found = true;
+				}
+			}
+		}
+
+		cache_count = std::min(new_count, ForsythCacheSize);
+		std::copy(new_cache, new_cache + cache_count, cache);
+
+		//nothing in the cache has triangles left, restart from the next triangle in the input order
+		if (!found)
+		{
+			while (scan < num_triangles && emitted[scan])
+				++scan;
+			if (scan == num_triangles) break;
+			best = scan;
+		}
+	}
+
+	mesh.store(output, first);
+}
+
+void optimizeVertexCacheFifo(unsigned int *first, unsigned int *last, unsigned int cache_size)
+{
+	LocalMesh mesh(first, last);
+	if (mesh.numTriangles < 2) return;
+	const unsigned int num_triangles = mesh.numTriangles;
+	const unsigned int num_vertices = mesh.numVertices;
+	const unsigned int *indices = mesh.indices.data();
+	std::vector<unsigned int> &live = mesh.live;
+
+	//the FIFO cache is modelled by the time every vertex was transformed, as in analyzeVertexCache
+	std::vector<unsigned int> timestamps(num_vertices, 0);
+	std::vector<bool> emitted(num_triangles, false);
+	std::vector<unsigned int> dead_end;     //the vertices of the emitted triangles, the way back when a fan ends
+	std::vector<unsigned int> candidates;
+	ElementArray output;
+	output.reserve(num_triangles * 3);
+	unsigned int time = cache_size + 1;
+	unsigned int scan = 0;
+
+	//emit all triangles around the fanning vertex, then continue with the one of their vertices
+	//which will still be in the cache after its own triangles are emitted
+	int fanning = indices[0];
+	while (fanning >= 0)
+	{
+		candidates.clear();
+		for (unsigned int a = mesh.offsets[fanning]; a < mesh.offsets[fanning + 1]; ++a)
+		{
+			unsigned int t = mesh.adjacency[a];
+			if (emitted[t]) continue;
+			emitted[t] = true;
+
+			for (unsigned int k = 0; k < 3; ++k)
+			{
+				unsigned int v = indices[t * 3 + k];
+				output.push_back(v);
+				dead_end.push_back(v);
+				candidates.push_back(v);
+				--live[v];
+				if (time - timestamps[v] > cache_size)
+					timestamps[v] = time++;
+			}
+		}
+
+		fanning = -1;
+		int best_priority = -1;
+		for (unsigned int v : candidates)
+		{
+			if (live[v] == 0) continue;
+			int priority = 0;
+			if (time - timestamps[v] + 2 * live[v] <= cache_size)
+				priority = time - timestamps[v];
+			if (priority > best_priority)
+			{
+				fanning = v;
+				best_priority = priority;
+			}
+		}
+
+		if (fanning < 0)
+		{
+			while (!dead_end.empty() && fanning < 0)
+			{
+				unsigned int v = dead_end.back();
+				dead_end.pop_back();
+				if (live[v] > 0)
+					fanning = v;
+			}
+		}
+		if (fanning < 0)
+		{
+			while (scan < num_vertices && live[scan] == 0)
+				++scan;
+			if (scan < num_vertices)
+				fanning = scan;
+		}
+	}
+
+	mesh.store(output, first);
+}
+
+void optimizeVertexCache(ElementArray &indices)
+{
+	if (!indices.empty())
+		optimizeVertexCache(indices.data(), indices.data() + indices.size());
+}
+
+void optimizeVertexCacheFifo(ElementArray &indices, unsigned int cache_size)
+{
+	if (!indices.empty())
+		optimizeVertexCacheFifo(indices.data(), indices.data() + indices.size(), cache_size);
+}
+
+ElementArray optimizeVertexFetch(ElementArray &indices, unsigned int num_vertices)
+{
+	ElementArray remap(num_vertices, UINT_MAX);
+	unsigned int next = 0;
+	if (!indices.empty())
+		assignFetchOrder(indices.data(), indices.data() + indices.size(), remap, next);
+	for (auto &r : remap)
+		if (r == UINT_MAX)
+			r = next++;
+	return remap;
+}
+
+void optimizeGlyphMesh(Glyph3D &glyph, VertexCacheMethod method, VertexCacheStats *before, VertexCacheStats *after)
+{
+	const unsigned int num_vertices = glyph._vertices.size();
+	if (num_vertices == 0) return;
+
+	if (before)
+		before->add(analyzeVertexCache(glyph.getIndices(), num_vertices));
+
+	for (auto &elements : glyph._elements)
+	{
+		if (method == FORSYTH)
+			optimizeVertexCache(elements);
+		else
+			optimizeVertexCacheFifo(elements);
+	}
+
+	//the faces are drawn one after another, so the vertices are numbered across all of them
+	ElementArray remap(num_vertices, UINT_MAX);
+	unsigned int next = 0;
+	for (auto &elements : glyph._elements)
+		if (!elements.empty())
+			assignFetchOrder(elements.data(), elements.data() + elements.size(), remap, next);
+	for (auto &r : remap)
+		if (r == UINT_MAX)
+			r = next++;
+
+	Vec3Array vertices(num_vertices);
+	for (unsigned int v = 0; v < num_vertices; ++v)
+		vertices[remap[v]] = glyph._vertices[v];
+	glyph._vertices.swap(vertices);
+	if (glyph._normals.size() == num_vertices)
+	{
+		Vec3Array normals(num_vertices);
+		for (unsigned int v = 0; v < num_vertices; ++v)
+			normals[remap[v]] = glyph._normals[v];
+		glyph._normals.swap(normals);
+	}
+
+	if (after)
+		after->add(analyzeVertexCache(glyph.getIndices(), num_vertices));
+}
+
+void printVertexCacheStats(std::ostream &os, const char *name, const VertexCacheStats &before, const VertexCacheStats &after)
+{
+	os << name << " vertex cache(FIFO " << VertexCacheSize << "): " << after.triangles << " triangles, ACMR "
+		<< before.acmr() << " -> " << after.acmr() << ", ATVR " << before.atvr() << " -> " << after.atvr() << std::endl;
+}
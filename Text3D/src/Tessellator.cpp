@@ -1,7 +1,12 @@
 #include "..\include\Tessellator.h"
 
+#include <cmath>
+
 Tessellator::Tessellator() :
-_numberVerts(0)
+_primMode(GL_TRIANGLES),
+_primCount(0),
+_numberVerts(0),
+_vertexBase(nullptr)
 {
 	_tobj = gluNewTess();
 	if (_tobj)
@@ -13,7 +18,6 @@ _numberVerts(0)
 		gluTessCallback(_tobj, GLU_TESS_ERROR_DATA, (GLU_TESS_CALLBACK)errorCallback);
 	}
 	_errorCode = 0;
-	_index = 0;
 }
 
 Tessellator::~Tessellator()
@@ -70,24 +74,24 @@ void Tessellator::endTessellation()
 
 void Tessellator::reset()
 {
-	for (Vec3dList::iterator i = _coordData.begin(); i != _coordData.end(); ++i)
-	{
-		delete (*i);
-	}
+	//the scratch objects go back to their pools, nothing is freed until the tessellator is destroyed
+	_coordData.reset();
+	_combineVertices.reset();
 
-	for (NewVertexList::iterator j = _newVertexList.begin(); j != _newVertexList.end(); ++j)
-	{
-		NewVertex& newVertex = (*j);
-		delete newVertex._vpos;
-		newVertex._vpos = NULL;
-	}
-
-	_coordData.clear();
 	_newVertexList.clear();
-	_primList.clear();
+	_triangles.clear();
 	_errorCode = 0;
 }
 
+bool Tessellator::tessellate(Glyph3D &geom)
+{
+	if (_triangulator.triangulate(geom))
+		return true;
+
+	retessellatePolygons(geom);
+	return _errorCode == 0;
+}
+
 void Tessellator::retessellatePolygons(Glyph3D &geom)
 {
 	// turn the contour list into primitives, a little like Tessellator does but more generally
@@ -95,18 +99,12 @@ void Tessellator::retessellatePolygons(Glyph3D &geom)
 
 	if (!vertices || vertices->empty() || geom._elements.empty()) return;
 
-	_index = 0; // reset the counter for indexed vertices
-	_extraPrimitives = 0;
-	if (!_numberVerts)
-	{
-		_numberVerts = geom.getVertexPos()->size();
-		// save the contours for complex (winding rule) tessellations
-		_Contours = geom._elements;
-	}
+	_numberVerts = geom.getVertexPos()->size();
+	_vertexBase = geom.getVertexPos()->data();
 
-	// remove the existing primitives.
-	unsigned int nprimsetoriginal = geom.getElementsNum();
-	if (nprimsetoriginal) geom.removeElements(0, nprimsetoriginal);
+	// save the contours of this glyph for complex (winding rule) tessellations, and remove the existing primitives.
+	_Contours.swap(geom._elements);
+	geom._elements.clear();
 
 	// the main difference from osgUtil::Tessellator for Glyph3D sets of multiple contours is that the begin/end tessellation
 	// occurs around the whole set of contours.
@@ -121,7 +119,7 @@ void Tessellator::retessellatePolygons(Glyph3D &geom)
 		addContour(primitive, vertices);
 	}
 	endTessellation();
-	collectTessellation(geom, 0);
+	collectTessellation(geom);
 }
 
 void Tessellator::addContour(ElementArray* primitive, Vec3Array* vertices)
@@ -145,8 +143,7 @@ void Tessellator::addVertex(glm::vec3* vertex)
 	{
 		if (vertex)
 		{
-			Vec3d* data = new Vec3d;
-			_coordData.push_back(data);
+			Vec3d* data = _coordData.next();
 			(*data)._v[0] = (*vertex)[0];
 			(*data)._v[1] = (*vertex)[1];
 			(*data)._v[2] = (*vertex)[2];
@@ -155,7 +152,7 @@ void Tessellator::addVertex(glm::vec3* vertex)
 	}
 }
 
-void Tessellator::handleNewVertices(Glyph3D& geom, VertexPtrToIndexMap &vertexPtrToIndexMap)
+void Tessellator::handleNewVertices(Glyph3D& geom)
 {
 	if (!_newVertexList.empty())
 	{
@@ -169,8 +166,7 @@ void Tessellator::handleNewVertices(Glyph3D& geom, VertexPtrToIndexMap &vertexPt
 			NewVertex& newVertex = (*itr);
 			glm::vec3* vertex = newVertex._vpos;
 
-			// assign vertex.
-			vertexPtrToIndexMap[vertex] = vertices->size();
+			// assign vertex, its index is the one given by combineCallback.
 			vertices->push_back(*vertex);
 		}
 	}
@@ -178,15 +174,42 @@ void Tessellator::handleNewVertices(Glyph3D& geom, VertexPtrToIndexMap &vertexPt
 
 void Tessellator::begin(GLenum mode)
 {
-	_primList.push_back(new Prim(mode));
+	_primMode = mode;
+	_primCount = 0;
 }
 
 void Tessellator::vertex(glm::vec3* vertex)
 {
-	if (!_primList.empty())
+	// the index of a new vertex is known since combineCallback, so it is resolved at once
+	// and the fans and strips are unrolled to triangles while GLU emits them.
+	unsigned int index = vertexIndex(vertex);
+	unsigned int n = _primCount++;
+	if (n < 2)
+	{
+		_primIndices[n] = index;
+		return;
+	}
+
+	switch (_primMode)
 	{
-		Prim* prim = _primList.back();
-		prim->_vertices.push_back(vertex);
+	case GL_TRIANGLES:
+		if (n % 3 == 2)
+			addTriangle(_primIndices[0], _primIndices[1], index);
+		else
+			_primIndices[n % 3] = index;
+		break;
+	case GL_TRIANGLE_STRIP:
+		if (n % 2) addTriangle(_primIndices[0], index, _primIndices[1]);
+		else       addTriangle(_primIndices[0], _primIndices[1], index);
+		_primIndices[0] = _primIndices[1];
+		_primIndices[1] = index;
+		break;
+	case GL_TRIANGLE_FAN:
+		addTriangle(_primIndices[0], _primIndices[1], index);
+		_primIndices[1] = index;
+		break;
+	default:
+		break;
 	}
 }
 
@@ -228,9 +251,13 @@ void Tessellator::combineCallback(GLdouble coords[3], void* vertex_data[4],
 	GLfloat weight[4], void** outData,
 	void* userData)
 {
-	glm::vec3* newData = new glm::vec3(coords[0], coords[1], coords[2]);
-	*outData = newData;
-	((Tessellator*)userData)->combine(newData, vertex_data, weight);
+	Tessellator* ts = (Tessellator*)userData;
+	CombineVertex* newData = ts->_combineVertices.next();
+	newData->_pos = glm::vec3(coords[0], coords[1], coords[2]);
+	// the new vertices are appended to the glyph in the order they are created
+	newData->_index = ts->_numberVerts + ts->_newVertexList.size();
+	*outData = &newData->_pos;
+	ts->combine(&newData->_pos, vertex_data, weight);
 }
 
 void Tessellator::errorCallback(GLenum errorCode, void* userData)
@@ -238,177 +265,187 @@ void Tessellator::errorCallback(GLenum errorCode, void* userData)
 	((Tessellator*)userData)->error(errorCode);
 }
 
-void Tessellator::collectTessellation(Glyph3D &geom, unsigned int originalIndex)
+unsigned int Tessellator::vertexIndex(const glm::vec3* vertex) const
 {
-	Vec3Array* vertices = geom.getVertexPos();
-	VertexPtrToIndexMap vertexPtrToIndexMap;
-
-	// populate the VertexPtrToIndexMap.
-	for (unsigned int vi = 0; vi < vertices->size(); ++vi)
-	{
-		vertexPtrToIndexMap[&((*vertices)[vi])] = vi;
-	}
-
-	handleNewVertices(geom, vertexPtrToIndexMap);
+	// a vertex of the glyph is found by its address, a new vertex from combineCallback carries its index.
+	std::less<const glm::vec3*> before;
+	if (!before(vertex, _vertexBase) && before(vertex, _vertexBase + _numberVerts))
+		return vertex - _vertexBase;
+	return reinterpret_cast<const CombineVertex*>(vertex)->_index;
+}
 
+void Tessellator::collectTessellation(Glyph3D &geom)
+{
+	geom._elements.assign(1, _triangles);
 	geom.clearModeList();
+	geom.addMode(GL_TRIANGLES);
 
-	for (PrimList::iterator primItr = _primList.begin();
-		primItr != _primList.end();
-		++primItr, ++_index)
-	{
-		Prim* prim = *primItr;
+	// the new vertices are added after the indices are resolved, adding them may move the vertices of the glyph.
+	handleNewVertices(geom);
+}
 
-		ElementArray elements;
-		for (Prim::VecList::iterator vitr = prim->_vertices.begin();
-			vitr != prim->_vertices.end();
-			++vitr)
-		{
-			elements.push_back(vertexPtrToIndexMap[*vitr]);
-		}
-		geom.addMode(prim->_mode);
-		// add to the drawn primitive list.
-		geom.addPrimitiveSet(&elements);
-	}
+bool computeGlyphGeometry(Glyph3D &glyph, float width, float crease_angle)
+{
+	Tessellator ts;
+	return computeGlyphGeometry(glyph, width, ts, crease_angle);
 }
 
-void computeGlyphGeometry(Glyph3D &glyph, float width)
+bool computeGlyphGeometry(Glyph3D &glyph, float width, Tessellator &ts, float crease_angle)
 {
 	Vec3Array *vertices = glyph.getVertexPos();
+	//glyphs without outline(e.g. space) have nothing to extrude
+	if (vertices->empty() || glyph._elements.empty()) return true;
+
 	Vec3Array origin_vertices = *vertices;
-	Vec3Array normals;
 	std::vector<ElementArray> origin_indices = glyph._elements;
 
-	Tessellator ts;
-	ts.retessellatePolygons(glyph);
+	//GLU is only used for the contours that can't be triangulated by ear clipping(e.g. self-intersecting contours)
+	if (!ts.tessellate(glyph))
+	{
+		glyph._elements.clear();
+		glyph.clearModeList();
+		return false;
+	}
 
-	//generate triangle indices
-	TriangleIndexFunctor<CollectTriangleIndicesFunctor> ctif;
-	glyph.accept(ctif);
-	CollectTriangleIndicesFunctor::Indices& indices = ctif._indices;
+	//both tessellation paths give one GL_TRIANGLES primitive, flip it to the front face's winding and drop degenerate triangles
+	const ElementArray &triangles = glyph._elements.front();
+	ElementArray indices;
+	indices.reserve(triangles.size());
+	for (unsigned int i = 0; i + 2 < triangles.size(); i += 3)
+	{
+		unsigned int p1 = triangles[i], p2 = triangles[i + 1], p3 = triangles[i + 2];
+		if (p1 == p2 || p2 == p3 || p1 == p3) continue;
+		indices.push_back(p1);
+		indices.push_back(p3);
+		indices.push_back(p2);
+	}
 
 	//rebuild the primitives of text3D, generate front face, wall face and back face
 	glyph._elements.clear();
 	glyph.clearModeList();
 
-	if (indices.empty()) std::cout << "The new indices create failed!" << std::endl;
-
-	//front face
-	ElementArray front_face;
-	for (unsigned int i = 0; i < indices.size(); ++i)
+	if (indices.empty())
 	{
-		front_face.push_back(indices[i]);
-		normals.push_back(glm::vec3(0.0f, 0.0f, 1.0f));
+		std::cout << "The new indices create failed!" << std::endl;
+		return false;
 	}
 
-	glyph.addPrimitiveSet(&front_face);
-	glyph.addNormalArray(normals);
-	glyph.addMode(GL_TRIANGLES);
+	//the mesh is indexed, a vertex is shared by all triangles that have the same position and normal at it
+	Vec3Array positions, normals;
+	auto addVertex = [&positions, &normals](const glm::vec3 &pos, const glm::vec3 &normal)
+	{
+		positions.push_back(pos);
+		normals.push_back(normal);
+		return static_cast<unsigned int>(positions.size() - 1);
+	};
 
-	//back face
+	//front face and back face, every tessellated vertex is used once by each face
 	const unsigned int NULL_VALUE = UINT_MAX;
-	ElementArray back_indices;
-	back_indices.resize(vertices->size(), NULL_VALUE);
 	glm::vec3 forward(0, 0, -width);
-	normals.clear();
+	ElementArray front_indices(vertices->size(), NULL_VALUE);
+	ElementArray back_indices(vertices->size(), NULL_VALUE);
 
-	ElementArray back_face;
-	for (unsigned int i = 0; i < indices.size() - 2;)
+	ElementArray front_face, back_face;
+	front_face.reserve(indices.size());
+	back_face.reserve(indices.size());
+	for (unsigned int i = 0; i < indices.size(); ++i)
 	{
-		unsigned int p1 = indices[i++];
-		unsigned int p2 = indices[i++];
-		unsigned int p3 = indices[i++];
-		if (back_indices[p1] == NULL_VALUE)
-		{
-			back_indices[p1] = vertices->size();
-			vertices->push_back((*vertices)[p1] + forward);
-		}
-
-		if (back_indices[p2] == NULL_VALUE)
-		{
-			back_indices[p2] = vertices->size();
-			vertices->push_back((*vertices)[p2] + forward);
-		}
-
-		if (back_indices[p3] == NULL_VALUE)
+		unsigned int p = indices[i];
+		if (front_indices[p] == NULL_VALUE)
+			front_indices[p] = addVertex((*vertices)[p], glm::vec3(0.0f, 0.0f, 1.0f));
+		front_face.push_back(front_indices[p]);
+	}
+	for (unsigned int i = 0; i + 2 < indices.size(); i += 3)
+	{
+		for (unsigned int k = 0; k < 3; ++k)
 		{
-
-			back_indices[p3] = vertices->size();
-			vertices->push_back((*vertices)[p3] + forward);
+			unsigned int p = indices[i + k];
+			if (back_indices[p] == NULL_VALUE)
+				back_indices[p] = addVertex((*vertices)[p] + forward, glm::vec3(0.0f, 0.0f, -1.0f));
 		}
-
-		back_face.push_back(back_indices[p1]);
-		back_face.push_back(back_indices[p3]);
-		back_face.push_back(back_indices[p2]);
-
-		normals.push_back(glm::vec3(0.0f, 0.0f, -1.0f));
-		normals.push_back(glm::vec3(0.0f, 0.0f, -1.0f));
-		normals.push_back(glm::vec3(0.0f, 0.0f, -1.0f));
+		back_face.push_back(back_indices[indices[i]]);
+		back_face.push_back(back_indices[indices[i + 2]]);
+		back_face.push_back(back_indices[indices[i + 1]]);
 	}
-	
+
+	glyph.addPrimitiveSet(&front_face);
+	glyph.addMode(GL_TRIANGLES);
 	glyph.addPrimitiveSet(&back_face);
-	glyph.addNormalArray(normals);
 	glyph.addMode(GL_TRIANGLES);
 
-	//wall face
-	unsigned int orig_size = origin_vertices.size();
-	ElementArray frontedge_indices, backedge_indices;
-	frontedge_indices.resize(orig_size, NULL_VALUE);
-	backedge_indices.resize(orig_size, NULL_VALUE);
+	//wall face, a quad per contour segment
+	//at a contour vertex the normals of the two quads are averaged if the angle between them is below the crease angle,
+	//so the walls of smooth curves share their vertices and only the corners stay sharp
+	const float cos_crease = std::cos(glm::radians(crease_angle));
+	auto isSmooth = [crease_angle, cos_crease](const glm::vec3 &n1, const glm::vec3 &n2)
+	{
+		return n1 == n2 || (crease_angle > 0.0f && glm::dot(n1, n2) >= cos_crease);
+	};
 
-	for (ElementArray elements : origin_indices)
+	Vec3Array segment_normals;
+	ElementArray in_front, in_back, out_front, out_back;
+	for (const ElementArray &elements : origin_indices)
 	{
-		normals.clear();
+		ElementArray wall_face;
+		unsigned int num_segments = elements.size() < 2 ? 0 : elements.size() - 1;
+		bool closed = num_segments > 0 && elements.back() == elements.front();
+		unsigned int num_joints = closed ? num_segments : num_segments + 1;
+
+		segment_normals.clear();
+		for (unsigned int k = 0; k < num_segments; ++k)
+		{
+			const glm::vec3 &p1 = origin_vertices[elements[k]];
+			const glm::vec3 &p2 = origin_vertices[elements[k + 1]];
+			segment_normals.push_back(glm::normalize(glm::cross(glm::vec3(0, 0, width), p2 - p1)));
+		}
 
-		ElementArray edging;
-		if (!elements.empty())
+		//the wall vertices at a contour vertex, "in" starts the next segment and "out" ends the previous one
+		//they are the same vertices if the contour is smooth there
+		in_front.assign(num_joints, NULL_VALUE);
+		in_back.assign(num_joints, NULL_VALUE);
+		out_front.assign(num_joints, NULL_VALUE);
+		out_back.assign(num_joints, NULL_VALUE);
+		for (unsigned int j = 0; j < num_joints; ++j)
 		{
-			for (unsigned int i = 0; i < elements.size(); ++i)
+			const glm::vec3 &p = origin_vertices[elements[j]];
+			int prev = j > 0 ? j - 1 : (closed ? num_segments - 1 : -1);
+			int next = j < num_segments ? j : -1;
+			if (prev >= 0 && next >= 0 && isSmooth(segment_normals[prev], segment_normals[next]))
+			{
+				const glm::vec3 &n1 = segment_normals[prev], &n2 = segment_normals[next];
+				glm::vec3 normal = n1 == n2 ? n1 : glm::normalize(n1 + n2);
+				in_front[j] = out_front[j] = addVertex(p, normal);
+				in_back[j] = out_back[j] = addVertex(p + forward, normal);
+				continue;
+			}
+			if (prev >= 0)
 			{
-				unsigned int ei = elements[i];
-				if (frontedge_indices[ei] == NULL_VALUE)
-				{
-					frontedge_indices[ei] = vertices->size();
-					vertices->push_back(origin_vertices[ei]);
-				}
-				if (backedge_indices[ei] == NULL_VALUE)
-				{
-					backedge_indices[ei] = vertices->size();
-					vertices->push_back(origin_vertices[ei] + forward);
-				}
-
-				edging.push_back(backedge_indices[ei]);
-				edging.push_back(frontedge_indices[ei]);
+				out_front[j] = addVertex(p, segment_normals[prev]);
+				out_back[j] = addVertex(p + forward, segment_normals[prev]);
+			}
+			if (next >= 0)
+			{
+				in_front[j] = addVertex(p, segment_normals[next]);
+				in_back[j] = addVertex(p + forward, segment_normals[next]);
 			}
 		}
 
-		std::vector<unsigned int> wall_face;
-		GLuint *iptr = &edging.front();
-		for (unsigned int i = 3; i < edging.size(); i += 2, iptr += 2)
+		for (unsigned int k = 0; k < num_segments; ++k)
 		{
-			glm::vec3 edge1((*vertices)[*(iptr + 1)] - (*vertices)[*iptr]);
-			glm::vec3 edge2((*vertices)[*(iptr + 2)] - (*vertices)[*iptr]);
-			glm::vec3 temp_normal = glm::cross(edge1, edge2);
-			wall_face.push_back(*(iptr));
-			wall_face.push_back(*(iptr + 1));
-			wall_face.push_back(*(iptr + 2));
-
-			temp_normal = glm::normalize(temp_normal);
-
-			normals.push_back(temp_normal);
-			normals.push_back(temp_normal);
-			normals.push_back(temp_normal);
-
-			wall_face.push_back(*(iptr + 1));
-			wall_face.push_back(*(iptr + 3));
-			wall_face.push_back(*(iptr + 2));
-
-			normals.push_back(temp_normal);
-			normals.push_back(temp_normal);
-			normals.push_back(temp_normal);
+			unsigned int j = (k + 1) % num_joints;
+			wall_face.push_back(in_back[k]);
+			wall_face.push_back(in_front[k]);
+			wall_face.push_back(out_back[j]);
+
+			wall_face.push_back(in_front[k]);
+			wall_face.push_back(out_front[j]);
+			wall_face.push_back(out_back[j]);
 		}
 		glyph.addPrimitiveSet(&wall_face);
-		glyph.addNormalArray(normals);
 		glyph.addMode(GL_TRIANGLES);
 	}
-}
\ No newline at end of file
+
+	vertices->swap(positions);
+	glyph._normals.swap(normals);
+	return true;
+}
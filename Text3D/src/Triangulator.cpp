@@ -0,0 +1,711 @@
+//the ear clipping is ported from mapbox earcut(https://github.com/mapbox/earcut), which is under the ISC license:
+//
+//ISC License
+//
+//Copyright (c) 2016, Mapbox
+//
+//Permission to use, copy, modify, and/or distribute this software for any purpose
+//with or without fee is hereby granted, provided that the above copyright notice
+//and this permission notice appear in all copies.
+//
+//THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD TO
+//THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+//IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+//CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA
+//OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION,
+//ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include "..\include\Triangulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//polygons with more vertices than this are indexed by z-order to find the points in a ear
+static const unsigned int ZOrderThreshold = 80;
+
+bool Triangulator::triangulate(Glyph3D &glyph)
+{
+	_vertices = &glyph._vertices;
+	_contours = &glyph._elements;
+	if (_vertices->empty() || _contours->empty()) return false;
+
+	_nodes.reset();
+	_rings.clear();
+	_triangles.clear();
+
+	//signed area and bounding box of every contour, the closing index is not a new vertex
+	double total = 0.0;
+	for (unsigned int c = 0; c < _contours->size(); ++c)
+	{
+		const ElementArray &contour = (*_contours)[c];
+		unsigned int n = contour.size();
+		if (n > 1 && contour[n - 1] == contour[0]) --n;
+		if (n < 3) continue;
+
+		Ring ring{ c, n, 0.0, glm::vec2((*_vertices)[contour[0]]), glm::vec2((*_vertices)[contour[0]]), -1 };
+		for (unsigned int i = 0, j = n - 1; i < n; j = i++)
+		{
+			const glm::vec3 &pi = (*_vertices)[contour[i]];
+			const glm::vec3 &pj = (*_vertices)[contour[j]];
+			ring.area += (double(pj.x) - pi.x) * (double(pj.y) + pi.y);
+			ring.minPos = glm::min(ring.minPos, glm::vec2(pi));
+			ring.maxPos = glm::max(ring.maxPos, glm::vec2(pi));
+		}
+		ring.area *= 0.5;   //counterclockwise is positive
+		//a contour without area covers nothing
+		if (ring.area == 0.0) continue;
+
+		total += ring.area;
+		_rings.push_back(ring);
+	}
+	if (_rings.empty() || total == 0.0) return false;
+
+	//the dominant orientation is the orientation of outer contours, GLU reverses the others to it as well
+	const double orientation = total > 0.0 ? 1.0 : -1.0;
+
+	//every hole belongs to the smallest outer contour containing it
+	for (auto &hole : _rings)
+	{
+		if (hole.area * orientation > 0.0) continue;
+
+		double parentArea = std::numeric_limits<double>::max();
+		const glm::vec3 &p = (*_vertices)[(*_contours)[hole.contour][0]];
+		for (unsigned int r = 0; r < _rings.size(); ++r)
+		{
+			const Ring &outer = _rings[r];
+			double outerArea = outer.area * orientation;
+			if (outerArea <= 0.0 || outerArea >= parentArea) continue;
+			if (hole.minPos.x < outer.minPos.x || hole.minPos.y < outer.minPos.y ||
+				hole.maxPos.x > outer.maxPos.x || hole.maxPos.y > outer.maxPos.y)
+				continue;
+			if (!containsPoint(outer, p)) continue;
+
+			hole.parent = r;
+			parentArea = outerArea;
+		}
+		if (hole.parent < 0) return false;
+	}
+
+	std::vector<const Ring*> &holes = _holes;
+	for (unsigned int r = 0; r < _rings.size(); ++r)
+	{
+		const Ring &outer = _rings[r];
+		if (outer.area * orientation <= 0.0) continue;
+
+		double expectedArea = std::abs(outer.area);
+		holes.clear();
+		for (const auto &hole : _rings)
+		{
+			if (hole.parent == int(r))
+			{
+				holes.push_back(&hole);
+				expectedArea -= std::abs(hole.area);
+			}
+		}
+
+		unsigned int firstTriangle = _triangles.size();
+		Node *node = linkedList(outer, true);
+		if (!node || node->next == node->prev) continue;
+		if (!holes.empty())
+			node = eliminateHoles(holes, node);
+
+		_invSize = 0.0;
+		unsigned int numPoints = outer.size;
+		for (auto h : holes)
+			numPoints += h->size;
+		if (numPoints > ZOrderThreshold)
+		{
+			_minX = outer.minPos.x;
+			_minY = outer.minPos.y;
+			double size = std::max(double(outer.maxPos.x) - _minX, double(outer.maxPos.y) - _minY);
+			_invSize = size != 0.0 ? 32767.0 / size : 0.0;
+		}
+
+		earcutLinked(node, 0);
+
+		//the triangles must cover the contour exactly, otherwise the contours overlap themselves
+		double area = 0.0;
+		for (unsigned int t = firstTriangle; t < _triangles.size(); t += 3)
+		{
+			const glm::vec3 &a = (*_vertices)[_triangles[t]];
+			const glm::vec3 &b = (*_vertices)[_triangles[t + 1]];
+			const glm::vec3 &c = (*_vertices)[_triangles[t + 2]];
+			area += std::abs((double(b.x) - a.x) * (double(c.y) - a.y) - (double(c.x) - a.x) * (double(b.y) - a.y)) * 0.5;
+		}
+		if (std::abs(area - expectedArea) > 1e-5 * std::abs(outer.area) + 1e-9)
+			return false;
+	}
+
+	if (_triangles.empty()) return false;
+
+	//ear clipping gives counterclockwise triangles, GLU gives triangles in the dominant orientation
+	if (orientation < 0.0)
+		for (unsigned int t = 0; t < _triangles.size(); t += 3)
+			std::swap(_triangles[t + 1], _triangles[t + 2]);
+
+	glyph._elements.assign(1, _triangles);
+	glyph.clearModeList();
+	glyph.addMode(GL_TRIANGLES);
+	return true;
+}
+
+bool Triangulator::containsPoint(const Ring &ring, const glm::vec3 &p) const
+{
+	const ElementArray &contour = (*_contours)[ring.contour];
+	bool inside = false;
+	for (unsigned int i = 0, j = ring.size - 1; i < ring.size; j = i++)
+	{
+		const glm::vec3 &a = (*_vertices)[contour[i]];
+		const glm::vec3 &b = (*_vertices)[contour[j]];
+		if ((a.y > p.y) != (b.y > p.y) &&
+			p.x < (double(b.x) - a.x) * (double(p.y) - a.y) / (double(b.y) - a.y) + a.x)
+			inside = !inside;
+	}
+	return inside;
+}
+
+//create a circular doubly linked list of the ring in the specified orientation
+Triangulator::Node* Triangulator::linkedList(const Ring &ring, bool ccw)
+{
+	const ElementArray &contour = (*_contours)[ring.contour];
+	Node *last = nullptr;
+	if (ccw == (ring.area > 0.0))
+		for (unsigned int i = 0; i < ring.size; ++i)
+			last = insertNode(contour[i], last);
+	else
+		for (unsigned int i = ring.size; i-- > 0;)
+			last = insertNode(contour[i], last);
+
+	if (last && equals(last, last->next))
+	{
+		removeNode(last);
+		last = last->next;
+	}
+	return last;
+}
+
+Triangulator::Node* Triangulator::newNode(unsigned int i, double x, double y)
+{
+	Node *p = _nodes.next();
+	*p = Node{ i, x, y, nullptr, nullptr, nullptr, nullptr, 0, false };
+	return p;
+}
+
+Triangulator::Node* Triangulator::insertNode(unsigned int i, Node *last)
+{
+	const glm::vec3 &v = (*_vertices)[i];
+	Node *p = newNode(i, v.x, v.y);
+
+	if (!last)
+	{
+		p->prev = p;
+		p->next = p;
+	}
+	else
+	{
+		p->next = last->next;
+		p->prev = last;
+		last->next->prev = p;
+		last->next = p;
+	}
+	return p;
+}
+
+void Triangulator::removeNode(Node *p)
+{
+	p->next->prev = p->prev;
+	p->prev->next = p->next;
+
+	if (p->prevZ) p->prevZ->nextZ = p->nextZ;
+	if (p->nextZ) p->nextZ->prevZ = p->prevZ;
+}
+
+//eliminate duplicate and collinear points
+Triangulator::Node* Triangulator::filterPoints(Node *start, Node *end)
+{
+	if (!start) return start;
+	if (!end) end = start;
+
+	Node *p = start;
+	bool again;
+	do
+	{
+		again = false;
+		if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0.0))
+		{
+			removeNode(p);
+			p = end = p->prev;
+			if (p == p->next) break;
+			again = true;
+		}
+		else
+			p = p->next;
+	} while (again || p != end);
+
+	return end;
+}
+
+//link a to b with a diagonal, the polygon is split to two, return the node b of the second one
+Triangulator::Node* Triangulator::splitPolygon(Node *a, Node *b)
+{
+	Node *a2 = newNode(a->i, a->x, a->y);
+	Node *b2 = newNode(b->i, b->x, b->y);
+	Node *an = a->next;
+	Node *bp = b->prev;
+
+	a->next = b;
+	b->prev = a;
+
+	a2->next = an;
+	an->prev = a2;
+
+	b2->next = a2;
+	a2->prev = b2;
+
+	bp->next = b2;
+	b2->prev = bp;
+
+	return b2;
+}
+
+//link every hole into the outer ring to get a single polygon
+Triangulator::Node* Triangulator::eliminateHoles(const std::vector<const Ring*> &holes, Node *outer)
+{
+	std::vector<Node*> &queue = _holeQueue;
+	queue.clear();
+	for (auto h : holes)
+	{
+		Node *list = linkedList(*h, false);
+		if (!list) continue;
+		if (list == list->next) list->steiner = true;
+
+		//the leftmost point of the hole
+		Node *leftmost = list, *p = list;
+		do
+		{
+			if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y))
+				leftmost = p;
+			p = p->next;
+		} while (p != list);
+		queue.push_back(leftmost);
+	}
+
+	std::sort(queue.begin(), queue.end(), [](const Node *a, const Node *b) { return a->x < b->x; });
+
+	//process holes from left to right
+	for (Node *hole : queue)
+	{
+		Node *bridge = findHoleBridge(hole, outer);
+		if (!bridge) continue;
+
+		Node *bridgeReverse = splitPolygon(bridge, hole);
+		filterPoints(bridgeReverse, bridgeReverse->next);
+		outer = filterPoints(bridge, bridge->next);
+	}
+	return outer;
+}
+
+//find a vertex of the outer ring that can be linked to the leftmost point of the hole(David Eberly's algorithm)
+Triangulator::Node* Triangulator::findHoleBridge(Node *hole, Node *outer)
+{
+	Node *p = outer;
+	double hx = hole->x, hy = hole->y;
+	double qx = -std::numeric_limits<double>::infinity();
+	Node *m = nullptr;
+
+	//find a segment intersected by a ray from the hole's leftmost point to the left,
+	//the segment's endpoint with lesser x will be the potential connection point
+	do
+	{
+		if (hy <= p->y && hy >= p->next->y && p->next->y != p->y)
+		{
+			double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+			if (x <= hx && x > qx)
+			{
+				qx = x;
+				m = p->x < p->next->x ? p : p->next;
+				if (x == hx) return m;
+			}
+		}
+		p = p->next;
+	} while (p != outer);
+
+	if (!m) return nullptr;
+
+	//look for points inside the triangle of hole point, segment intersection and endpoint,
+	//if there are no points found, we have a valid connection,
+	//otherwise choose the point of the minimum angle with the ray as connection point
+	Node *stop = m;
+	double mx = m->x, my = m->y;
+	double tanMin = std::numeric_limits<double>::infinity();
+
+	p = m;
+	do
+	{
+		if (hx >= p->x && p->x >= mx && hx != p->x &&
+			pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y))
+		{
+			double tan = std::abs(hy - p->y) / (hx - p->x);
+			if (locallyInside(p, hole) &&
+				(tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p))))))
+			{
+				m = p;
+				tanMin = tan;
+			}
+		}
+		p = p->next;
+	} while (p != stop);
+
+	return m;
+}
+
+//cut ears of the polygon until only a triangle left, the later passes handle the polygons that have no ear left
+void Triangulator::earcutLinked(Node *ear, int pass)
+{
+	if (!ear) return;
+
+	if (pass == 0 && _invSize != 0.0) indexCurve(ear);
+
+	Node *stop = ear;
+	while (ear->prev != ear->next)
+	{
+		Node *prev = ear->prev;
+		Node *next = ear->next;
+
+		if (_invSize != 0.0 ? isEarHashed(ear) : isEar(ear))
+		{
+			_triangles.push_back(prev->i);
+			_triangles.push_back(ear->i);
+			_triangles.push_back(next->i);
+
+			removeNode(ear);
+
+			//skipping the next vertex leads to less sliver triangles
+			ear = next->next;
+			stop = next->next;
+			continue;
+		}
+
+		ear = next;
+
+		//if we looped through the whole remaining polygon and can't find any more ears
+		if (ear == stop)
+		{
+			//try filtering points and slicing again
+			if (pass == 0)
+				earcutLinked(filterPoints(ear), 1);
+			//if this didn't work, try curing all small self-intersections locally
+			else if (pass == 1)
+				earcutLinked(cureLocalIntersections(filterPoints(ear)), 2);
+			//as a last resort, try splitting the remaining polygon into two
+			else if (pass == 2)
+				splitEarcut(ear);
+			break;
+		}
+	}
+}
+
+//check whether a polygon node forms a valid ear with adjacent nodes
+bool Triangulator::isEar(Node *ear) const
+{
+	const Node *a = ear->prev, *b = ear, *c = ear->next;
+	//reflex, can't be an ear
+	if (area(a, b, c) >= 0.0) return false;
+
+	//no points of the polygon may be inside the ear
+	const Node *p = ear->next->next;
+	while (p != ear->prev)
+	{
+		if (pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && area(p->prev, p, p->next) >= 0.0)
+			return false;
+		p = p->next;
+	}
+	return true;
+}
+
+bool Triangulator::isEarHashed(Node *ear) const
+{
+	const Node *a = ear->prev, *b = ear, *c = ear->next;
+	if (area(a, b, c) >= 0.0) return false;
+
+	//bounding box of the triangle
+	double minTX = std::min({ a->x, b->x, c->x }), minTY = std::min({ a->y, b->y, c->y });
+	double maxTX = std::max({ a->x, b->x, c->x }), maxTY = std::max({ a->y, b->y, c->y });
+
+	//z-order range of the bounding box
+	unsigned int minZ = zOrder(minTX, minTY);
+	unsigned int maxZ = zOrder(maxTX, maxTY);
+
+	auto inEar = [&](const Node *p)
+	{
+		return p != ear->prev && p != ear->next &&
+			pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && area(p->prev, p, p->next) >= 0.0;
+	};
+
+	//look for points inside the triangle in both directions
+	const Node *p = ear->prevZ;
+	const Node *n = ear->nextZ;
+	while (p && p->z >= minZ && n && n->z <= maxZ)
+	{
+		if (inEar(p)) return false;
+		p = p->prevZ;
+		if (inEar(n)) return false;
+		n = n->nextZ;
+	}
+	while (p && p->z >= minZ)
+	{
+		if (inEar(p)) return false;
+		p = p->prevZ;
+	}
+	while (n && n->z <= maxZ)
+	{
+		if (inEar(n)) return false;
+		n = n->nextZ;
+	}
+	return true;
+}
+
+//go through all polygon nodes and cure small local self-intersections
+Triangulator::Node* Triangulator::cureLocalIntersections(Node *start)
+{
+	Node *p = start;
+	do
+	{
+		Node *a = p->prev, *b = p->next->next;
+		if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a))
+		{
+			_triangles.push_back(a->i);
+			_triangles.push_back(p->i);
+			_triangles.push_back(b->i);
+
+			//remove two nodes involved
+			removeNode(p);
+			removeNode(p->next);
+
+			p = start = b;
+		}
+		p = p->next;
+	} while (p != start);
+
+	return filterPoints(p);
+}
+
+//try splitting polygon into two and triangulate them independently
+void Triangulator::splitEarcut(Node *start)
+{
+	//look for a valid diagonal that divides the polygon into two
+	Node *a = start;
+	do
+	{
+		Node *b = a->next->next;
+		while (b != a->prev)
+		{
+			if (a->i != b->i && isValidDiagonal(a, b))
+			{
+				Node *c = splitPolygon(a, b);
+
+				a = filterPoints(a, a->next);
+				c = filterPoints(c, c->next);
+
+				earcutLinked(a, 0);
+				earcutLinked(c, 0);
+				return;
+			}
+			b = b->next;
+		}
+		a = a->next;
+	} while (a != start);
+}
+
+//interlink polygon nodes in z-order
+void Triangulator::indexCurve(Node *start)
+{
+	Node *p = start;
+	do
+	{
+		p->z = zOrder(p->x, p->y);
+		p->prevZ = p->prev;
+		p->nextZ = p->next;
+		p = p->next;
+	} while (p != start);
+
+	p->prevZ->nextZ = nullptr;
+	p->prevZ = nullptr;
+
+	sortLinked(p);
+}
+
+//Simon Tatham's linked list merge sort algorithm
+Triangulator::Node* Triangulator::sortLinked(Node *list)
+{
+	unsigned int inSize = 1;
+	unsigned int numMerges;
+	do
+	{
+		Node *p = list;
+		Node *tail = nullptr;
+		list = nullptr;
+		numMerges = 0;
+
+		while (p)
+		{
+			++numMerges;
+			Node *q = p;
+			unsigned int pSize = 0;
+			for (unsigned int i = 0; i < inSize; ++i)
+			{
+				++pSize;
+				q = q->nextZ;
+				if (!q) break;
+			}
+			unsigned int qSize = inSize;
+
+			while (pSize > 0 || (qSize > 0 && q))
+			{
+				Node *e;
+				if (pSize != 0 && (qSize == 0 || !q || p->z <= q->z))
+				{
+					e = p;
+					p = p->nextZ;
+					--pSize;
+				}
+				else
+				{
+					e = q;
+					q = q->nextZ;
+					--qSize;
+				}
+
+				if (tail) tail->nextZ = e;
+				else list = e;
+
+				e->prevZ = tail;
+				tail = e;
+			}
+			p = q;
+		}
+
+		tail->nextZ = nullptr;
+		inSize *= 2;
+	} while (numMerges > 1);
+
+	return list;
+}
+
+//z-order of a point given coords and inverse of the longer side of data bbox
+unsigned int Triangulator::zOrder(double x, double y) const
+{
+	//coords are transformed into non-negative 15-bit integer range
+	unsigned int ix = static_cast<unsigned int>(std::min(std::max((x - _minX) * _invSize, 0.0), 32767.0));
+	unsigned int iy = static_cast<unsigned int>(std::min(std::max((y - _minY) * _invSize, 0.0), 32767.0));
+
+	ix = (ix | (ix << 8)) & 0x00FF00FF;
+	ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+	ix = (ix | (ix << 2)) & 0x33333333;
+	ix = (ix | (ix << 1)) & 0x55555555;
+
+	iy = (iy | (iy << 8)) & 0x00FF00FF;
+	iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+	iy = (iy | (iy << 2)) & 0x33333333;
+	iy = (iy | (iy << 1)) & 0x55555555;
+
+	return ix | (iy << 1);
+}
+
+//signed area of a triangle, negative for counterclockwise
+double Triangulator::area(const Node *p, const Node *q, const Node *r)
+{
+	return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+//check if a point lies within a convex triangle
+bool Triangulator::pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+{
+	return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+		(ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+		(bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+static int sign(double v)
+{
+	return v > 0.0 ? 1 : v < 0.0 ? -1 : 0;
+}
+
+//for collinear points p, q, r, check if point q lies on segment pr
+static bool onSegment(double px, double py, double qx, double qy, double rx, double ry)
+{
+	return qx <= std::max(px, rx) && qx >= std::min(px, rx) && qy <= std::max(py, ry) && qy >= std::min(py, ry);
+}
+
+//check if two segments intersect
+bool Triangulator::intersects(const Node *p1, const Node *q1, const Node *p2, const Node *q2)
+{
+	int o1 = sign(area(p1, q1, p2));
+	int o2 = sign(area(p1, q1, q2));
+	int o3 = sign(area(p2, q2, p1));
+	int o4 = sign(area(p2, q2, q1));
+
+	if (o1 != o2 && o3 != o4) return true;
+
+	if (o1 == 0 && onSegment(p1->x, p1->y, p2->x, p2->y, q1->x, q1->y)) return true;
+	if (o2 == 0 && onSegment(p1->x, p1->y, q2->x, q2->y, q1->x, q1->y)) return true;
+	if (o3 == 0 && onSegment(p2->x, p2->y, p1->x, p1->y, q2->x, q2->y)) return true;
+	if (o4 == 0 && onSegment(p2->x, p2->y, q1->x, q1->y, q2->x, q2->y)) return true;
+
+	return false;
+}
+
+//check if a polygon diagonal intersects any polygon segments
+bool Triangulator::intersectsPolygon(const Node *a, const Node *b)
+{
+	const Node *p = a;
+	do
+	{
+		if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i &&
+			intersects(p, p->next, a, b))
+			return true;
+		p = p->next;
+	} while (p != a);
+	return false;
+}
+
+//check if a polygon diagonal is locally inside the polygon
+bool Triangulator::locallyInside(const Node *a, const Node *b)
+{
+	return area(a->prev, a, a->next) < 0.0 ?
+		area(a, b, a->next) >= 0.0 && area(a, a->prev, b) >= 0.0 :
+		area(a, b, a->prev) < 0.0 || area(a, a->next, b) < 0.0;
+}
+
+//check if the middle point of a polygon diagonal is inside the polygon
+bool Triangulator::middleInside(const Node *a, const Node *b)
+{
+	const Node *p = a;
+	bool inside = false;
+	double px = (a->x + b->x) / 2.0;
+	double py = (a->y + b->y) / 2.0;
+	do
+	{
+		if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+			(px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+			inside = !inside;
+		p = p->next;
+	} while (p != a);
+	return inside;
+}
+
+//check if a diagonal between two polygon nodes is valid(lies in polygon interior)
+bool Triangulator::isValidDiagonal(const Node *a, const Node *b)
+{
+	return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon(a, b) &&
+		((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+		(area(a->prev, a, b->prev) != 0.0 || area(a, b->prev, b) != 0.0)) ||
+		(equals(a, b) && area(a->prev, a, a->next) > 0.0 && area(b->prev, b, b->next) > 0.0));
+}
+
+//whether sector in vertex m contains sector in vertex p in the same coordinates
+bool Triangulator::sectorContainsSector(const Node *m, const Node *p)
+{
+	return area(m->prev, m, p->prev) < 0.0 && area(p->next, m, m->next) < 0.0;
+}
@@ -0,0 +1,133 @@
+#include "..\include\VertexQuantizer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+	const float UNormMax = 65535.0f;
+	const float SNormMax = 32767.0f;
+
+	//the worst angle between a normal and its decoded octahedral code of 2 snorm16 in degrees,
+	//sampling the sphere finds ~0.0037 with the float rounding of the encoding, the bound keeps a margin
+	const float OctMaxAngle = 0.005f;
+
+	GLushort toUNorm16(float v)
+	{
+		return static_cast<GLushort>(std::floor(glm::clamp(v, 0.0f, 1.0f) * UNormMax + 0.5f));
+	}
+
+	GLshort toSNorm16(float v)
+	{
+		return static_cast<GLshort>(std::floor(glm::clamp(v, -1.0f, 1.0f) * SNormMax + 0.5f));
+	}
+
+	//the conversion of opengl 4.2 and later, -32768 and -32767 both map to -1
+	float fromSNorm16(GLshort v)
+	{
+		return std::max(v / SNormMax, -1.0f);
+	}
+
+	float signNotZero(float v)
+	{
+		return v >= 0.0f ? 1.0f : -1.0f;
+	}
+}
+
+QuantizationBounds computeQuantizationBounds(const Vec3Array &positions)
+{
+	if (positions.empty())
+		return QuantizationBounds{ glm::vec3(0.0f), glm::vec3(0.0f) };
+
+	glm::vec3 bmin = positions[0], bmax = positions[0];
+	for (const auto &p : positions)
+	{
+		bmin = glm::min(bmin, p);
+		bmax = glm::max(bmax, p);
+	}
+	return QuantizationBounds{ bmin, bmax - bmin };
+}
+
+void octEncode(const glm::vec3 &n, GLshort out[2])
+{
+	//project to the octahedron, then fold the lower half over the upper one
+	glm::vec2 e = glm::vec2(n.x, n.y) / (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+	if (n.z < 0.0f)
+		e = glm::vec2((1.0f - std::abs(e.y)) * signNotZero(e.x), (1.0f - std::abs(e.x)) * signNotZero(e.y));
+
+	out[0] = toSNorm16(e.x);
+	out[1] = toSNorm16(e.y);
+}
+
+glm::vec3 octDecode(const GLshort in[2])
+{
+	glm::vec2 e(fromSNorm16(in[0]), fromSNorm16(in[1]));
+	glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+	if (n.z < 0.0f)
+	{
+		n.x = (1.0f - std::abs(e.y)) * signNotZero(e.x);
+		n.y = (1.0f - std::abs(e.x)) * signNotZero(e.y);
+	}
+	return glm::normalize(n);
+}
+
+QuantizedVertex quantizeVertex(const glm::vec3 &position, const glm::vec3 &normal, const QuantizationBounds &bounds)
+{
+	QuantizedVertex v;
+	for (int k = 0; k < 3; ++k)
+	{
+		float t = bounds.scale[k] > 0.0f ? (position[k] - bounds.offset[k]) / bounds.scale[k] : 0.0f;
+		v.position[k] = toUNorm16(t);
+	}
+	v.reserved = 0;
+	octEncode(normal, v.normal);
+	return v;
+}
+
+glm::vec3 dequantizePosition(const QuantizedVertex &v, const QuantizationBounds &bounds)
+{
+	glm::vec3 t(v.position[0] / UNormMax, v.position[1] / UNormMax, v.position[2] / UNormMax);
+	return bounds.offset + bounds.scale * t;
+}
+
+glm::vec3 dequantizeNormal(const QuantizedVertex &v)
+{
+	return octDecode(v.normal);
+}
+
+QuantizationBounds quantizeGlyph(const Glyph3D &glyph, std::vector<QuantizedVertex> &out)
+{
+	const Vec3Array &normals = glyph.getNormalArray();
+	QuantizationBounds bounds = computeQuantizationBounds(glyph._vertices);
+
+	out.clear();
+	out.reserve(glyph._vertices.size());
+	for (size_t i = 0; i < glyph._vertices.size() && i < normals.size(); ++i)
+		out.push_back(quantizeVertex(glyph._vertices[i], normals[i], bounds));
+	return bounds;
+}
+
+QuantizationError measureQuantizationError(const Vec3Array &positions, const Vec3Array &normals,
+	const QuantizedVertex *vertices, const QuantizationBounds &bounds)
+{
+	QuantizationError error{ 0.0f, 0.0f };
+	for (size_t i = 0; i < positions.size() && i < normals.size(); ++i)
+	{
+		error.position = std::max(error.position, glm::length(dequantizePosition(vertices[i], bounds) - positions[i]));
+
+		//atan2 keeps the small angles exact, acos of a dot product close to 1 doesn't
+		glm::vec3 n = glm::normalize(normals[i]), d = dequantizeNormal(vertices[i]);
+		float angle = std::atan2(glm::length(glm::cross(n, d)), glm::dot(n, d));
+		error.normalAngle = std::max(error.normalAngle, glm::degrees(angle));
+	}
+	return error;
+}
+
+QuantizationError maxQuantizationError(const QuantizationBounds &bounds)
+{
+	//half a unorm16 step, plus a few float roundings of the encoding and the decoding
+	glm::vec3 step = bounds.scale / UNormMax;
+	glm::vec3 magnitude = glm::abs(bounds.offset) + glm::abs(bounds.scale);
+	return QuantizationError{ 0.5f * glm::length(step) + 4.0f * FLT_EPSILON * glm::length(magnitude), OctMaxAngle };
+}